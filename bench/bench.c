@@ -0,0 +1,409 @@
+#include "../include/task.h"
+#include "../include/sched_new.h"
+#include "../include/utils.h"
+#include "../include/analysis.h"
+#include "../include/timeline.h"
+#include "../include/taskgen.h"
+#include "../include/rng.h"
+#include "../include/taskset_io.h"
+#include "../include/admission.h"
+#include "../include/batch_analysis.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+//scaling benchmark of the simulator, a baseline for performance regressions
+//for every task count of the sweep one synthetic taskset is drawn and simulated under every policy
+//each measurement runs in a forked child so its peak RSS is its own
+
+#define BENCH_TIMELINE_BUFFER 1024
+#define BENCH_UTILIZATION 0.9
+#define BENCH_SEED 2024
+#define BENCH_LOAD_TASKS 1000000
+#define BENCH_ADMISSION_ROUNDS 2000
+#define BENCH_BATCH_TASKSETS 20000
+#define BENCH_BATCH_ROUNDS 20
+
+typedef enum bench_analysis
+{
+    BENCH_ANALYSIS_NONE,
+    BENCH_ANALYSIS_RTA_RM,
+    BENCH_ANALYSIS_RTA_DM,
+    BENCH_ANALYSIS_QPA
+} BenchAnalysis;
+
+typedef struct bench_policy
+{
+    const char* name;
+    scheduler_fn scheduler;
+    BenchAnalysis analysis;
+} BenchPolicy;
+
+static const BenchPolicy bench_policies[] = {
+    { "RM", rate_monotonic_scheduler, BENCH_ANALYSIS_RTA_RM },
+    { "DM", deadline_monotonic_scheduler, BENCH_ANALYSIS_RTA_DM },
+    { "EDF", earliest_deadline_first_scheduler, BENCH_ANALYSIS_QPA },
+    { "FIFO", fifo_scheduler, BENCH_ANALYSIS_NONE },
+    { "LLF", least_laxity_first, BENCH_ANALYSIS_QPA },
+};
+#define NUM_BENCH_POLICIES ((int)(sizeof(bench_policies) / sizeof(bench_policies[0])))
+
+//what the child reports back through the pipe
+typedef struct bench_result
+{
+    long long releases;
+    long decisions;
+    double simulate_ns;
+    double analysis_ns;
+} BenchResult;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void discard_segment(const Segment* segment, void* context)
+{
+    (void) segment;
+    (void) context;
+}
+
+static double time_analysis(Task tasks[], int num_tasks, BenchAnalysis analysis)
+{
+    if(analysis == BENCH_ANALYSIS_NONE) return 0;
+
+    int* order = (int*) malloc(num_tasks * sizeof(int));
+    sched_time_t* wcrt = (sched_time_t*) malloc(num_tasks * sizeof(sched_time_t));
+    sched_time_t failing_interval;
+    double start = now_ns();
+    if(analysis == BENCH_ANALYSIS_QPA)
+    {
+        edf_demand_analysis(tasks, num_tasks, &failing_interval);
+    }
+    else
+    {
+        priority_order(tasks, num_tasks, analysis == BENCH_ANALYSIS_RTA_RM ? PRIORITY_RATE_MONOTONIC : PRIORITY_DEADLINE_MONOTONIC, order);
+        response_time_analysis(tasks, num_tasks, order, wcrt);
+    }
+    double elapsed = now_ns() - start;
+    free(order);
+    free(wcrt);
+    return elapsed;
+}
+
+static BenchResult measure(const BenchPolicy* policy, Task tasks[], int num_tasks, sched_time_t horizon)
+{
+    BenchResult result = {0};
+    result.analysis_ns = time_analysis(tasks, num_tasks, policy->analysis);
+
+    Taskset* taskset = new_Taskset(tasks, num_tasks);
+    Timeline timeline;
+    timeline_init_stream(&timeline, BENCH_TIMELINE_BUFFER, discard_segment, NULL);
+    double start = now_ns();
+    policy->scheduler(taskset, horizon, &timeline, NULL);
+    result.simulate_ns = now_ns() - start;
+    timeline_flush(&timeline);
+    result.decisions = timeline.decisions;
+    timeline_free(&timeline);
+    free_Taskset(taskset);
+
+    //every release in [0, horizon)
+    for(int i = 0; i < num_tasks; i++)
+    {
+        if(tasks[i].arrival_time < horizon)
+        {
+            result.releases += (horizon - 1 - tasks[i].arrival_time) / tasks[i].period + 1;
+        }
+    }
+    return result;
+}
+
+//run measure in a child, peak_rss_kb is the child's maximum resident set
+static bool measure_in_child(const BenchPolicy* policy, Task tasks[], int num_tasks, sched_time_t horizon, BenchResult* result, long* peak_rss_kb)
+{
+    int channel[2];
+    if(pipe(channel) != 0) return false;
+
+    pid_t child = fork();
+    if(child < 0) return false;
+    if(child == 0)
+    {
+        close(channel[0]);
+        BenchResult measured = measure(policy, tasks, num_tasks, horizon);
+        ssize_t written = write(channel[1], &measured, sizeof(measured));
+        _exit(written == sizeof(measured) ? 0 : 1);
+    }
+
+    close(channel[1]);
+    ssize_t got = read(channel[0], result, sizeof(*result));
+    close(channel[0]);
+
+    int status;
+    struct rusage usage;
+    if(wait4(child, &status, 0, &usage) < 0) return false;
+    *peak_rss_kb = usage.ru_maxrss;
+    return got == sizeof(*result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+//time the text loader, the binary loader and the binary mapping on one large generated taskset
+static void bench_loading(Rng* rng)
+{
+    TaskgenParams params;
+    taskgen_default_params(&params);
+    params.num_tasks = BENCH_LOAD_TASKS;
+    params.utilization = BENCH_UTILIZATION;
+    int num_tasks = 0;
+    Task* tasks = generate_taskset(&params, rng, &num_tasks);
+    if(tasks == NULL)
+    {
+        fprintf(stderr,"[ERROR]: could not draw the loading taskset\n");
+        return;
+    }
+
+    char text_path[] = "/tmp/bench_tasksetXXXXXX";
+    char binary_path[] = "/tmp/bench_tasksetXXXXXX";
+    int text_fd = mkstemp(text_path);
+    int binary_fd = mkstemp(binary_path);
+    FILE* text = fdopen(text_fd, "w");
+    FILE* binary = fdopen(binary_fd, "wb");
+    write_taskset(text, tasks, num_tasks);
+    write_taskset_binary(binary, tasks, num_tasks);
+    fclose(text);
+    fclose(binary);
+    free(tasks);
+
+    int loaded = 0;
+    double start = now_ns();
+    Task* from_text = load_taskset_text(text_path, &loaded);
+    double text_ms = (now_ns() - start) * 1e-6;
+    free(from_text);
+
+    start = now_ns();
+    Task* from_binary = load_taskset_binary(binary_path, &loaded);
+    double binary_ms = (now_ns() - start) * 1e-6;
+    free(from_binary);
+
+    TasksetMap map = { NULL, 0, NULL, 0 };
+    start = now_ns();
+    map_taskset_binary(binary_path, &map);
+    double map_ms = (now_ns() - start) * 1e-6;
+    unmap_taskset(&map);
+
+    printf("loading %d tasks: text %.1f ms, binary %.1f ms, mapped binary %.1f ms\n", num_tasks, text_ms, binary_ms, map_ms);
+    unlink(text_path);
+    unlink(binary_path);
+}
+
+//online admission: how long "can this task join?" takes against a steady taskset,
+//set against a full response time analysis of the taskset with the candidate in it
+static void bench_admission(TaskgenParams* params, Rng* rng, int num_tasks)
+{
+    params->num_tasks = num_tasks;
+    int count = 0;
+    Task* tasks = generate_taskset(params, rng, &count);
+    if(tasks == NULL)
+    {
+        return;
+    }
+
+    //the last quarter of the draw only ever asks to join
+    AdmissionControl* control = new_AdmissionControl(ADMISSION_FIXED_PRIORITY, PRIORITY_DEADLINE_MONOTONIC);
+    int resident = count - count / 4;
+    int admitted = 0;
+    for(int i = 0; i < resident; i++)
+    {
+        if(admission_add(control, &tasks[i]) >= 0) admitted++;
+    }
+
+    int accepted = 0;
+    double start = now_ns();
+    for(int round = 0; round < BENCH_ADMISSION_ROUNDS; round++)
+    {
+        accepted += admission_can_add(control, &tasks[resident + round % (count - resident)]);
+    }
+    double incremental_ns = (now_ns() - start) / BENCH_ADMISSION_ROUNDS;
+
+    int rounds = BENCH_ADMISSION_ROUNDS / 20;
+    Task* candidate_set = (Task*) malloc((control->num_tasks + 1) * sizeof(Task));
+    int* order = (int*) malloc((control->num_tasks + 1) * sizeof(int));
+    sched_time_t* wcrt = (sched_time_t*) malloc((control->num_tasks + 1) * sizeof(sched_time_t));
+    memcpy(candidate_set, control->tasks, control->num_tasks * sizeof(Task));
+    start = now_ns();
+    for(int round = 0; round < rounds; round++)
+    {
+        candidate_set[control->num_tasks] = tasks[resident + round % (count - resident)];
+        priority_order(candidate_set, control->num_tasks + 1, PRIORITY_DEADLINE_MONOTONIC, order);
+        response_time_analysis(candidate_set, control->num_tasks + 1, order, wcrt);
+    }
+    double full_ns = (now_ns() - start) / rounds;
+
+    printf("admission against %d DM tasks: %d of %d candidates fit, incremental %.2f us per query, full RTA %.2f us\n",
+        admitted, accepted, BENCH_ADMISSION_ROUNDS, incremental_ns * 1e-3, full_ns * 1e-3);
+    free(candidate_set);
+    free(order);
+    free(wcrt);
+    free(tasks);
+    free_AdmissionControl(control);
+}
+
+//fixed priority assignment over one taskset: deadline monotonic order plus RTA against Audsley's search,
+//deadlines run up to past the period so deadline monotonic is no longer optimal
+static void bench_priority_assignment(TaskgenParams* params, Rng* rng, int num_tasks)
+{
+    TaskgenParams draw = *params;
+    draw.num_tasks = num_tasks;
+    draw.utilization = 0.8;
+    draw.deadline_ratio_min = 0.5;
+    draw.deadline_ratio_max = 1.5;
+    int count = 0;
+    Task* tasks = generate_taskset(&draw, rng, &count);
+    if(tasks == NULL)
+    {
+        return;
+    }
+
+    int* order = (int*) malloc(count * sizeof(int));
+    sched_time_t* wcrt = (sched_time_t*) malloc(count * sizeof(sched_time_t));
+    double start = now_ns();
+    priority_order(tasks, count, PRIORITY_DEADLINE_MONOTONIC, order);
+    bool deadline_monotonic = response_time_analysis(tasks, count, order, wcrt);
+    double deadline_monotonic_ns = now_ns() - start;
+    start = now_ns();
+    bool optimal = optimal_priority_order(tasks, count, order, wcrt);
+    double optimal_ns = now_ns() - start;
+
+    printf("priority assignment over %d tasks: DM + RTA %.1f us (%s), OPA %.1f us (%s)\n", count,
+        deadline_monotonic_ns * 1e-3, deadline_monotonic ? "schedulable" : "not schedulable",
+        optimal_ns * 1e-3, optimal ? "schedulable" : "not schedulable");
+    free(order);
+    free(wcrt);
+    free(tasks);
+}
+
+//bulk screening of generated tasksets, throughput of every batch kernel the cpu has and whether they agree
+static void bench_batch(TaskgenParams* params, Rng* rng)
+{
+    TaskgenParams draw = *params;
+    TasksetBatch* batch = new_TasksetBatch(BENCH_BATCH_TASKSETS);
+    long long total_tasks = 0;
+    for(int k = 0; k < BENCH_BATCH_TASKSETS; k++)
+    {
+        //task counts 2..64, every other taskset with implicit deadlines so the RM and exact EDF bits get exercised
+        draw.num_tasks = 2 + (int) rng_below(rng, 63);
+        draw.utilization = 0.5 + 0.6 * rng_uniform(rng);
+        draw.deadline_ratio_min = k % 2 ? params->deadline_ratio_min : 1.0;
+        draw.deadline_ratio_max = k % 2 ? params->deadline_ratio_max : 1.0;
+        int count = 0;
+        Task* tasks = generate_taskset(&draw, rng, &count);
+        if(tasks == NULL)
+        {
+            continue;
+        }
+        taskset_batch_add(batch, tasks, count);
+        total_tasks += count;
+        free(tasks);
+    }
+
+    uint8_t* reference = (uint8_t*) malloc(batch->num_tasksets);
+    uint8_t* verdicts = (uint8_t*) malloc(batch->num_tasksets);
+    const BatchKernel kernels[] = { BATCH_KERNEL_SCALAR, BATCH_KERNEL_SSE2, BATCH_KERNEL_AVX2 };
+    for(int i = 0; i < (int)(sizeof(kernels) / sizeof(kernels[0])); i++)
+    {
+        if(batch_kernel_available(kernels[i]) != kernels[i])
+        {
+            printf("batch kernel %s: not available\n", batch_kernel_name(kernels[i]));
+            continue;
+        }
+        double start = now_ns();
+        for(int round = 0; round < BENCH_BATCH_ROUNDS; round++)
+        {
+            analyse_taskset_batch(batch, kernels[i], i == 0 ? reference : verdicts, NULL);
+        }
+        double per_round = (now_ns() - start) / BENCH_BATCH_ROUNDS;
+        int disagree = i == 0 ? 0 : -1;
+        if(i > 0)
+        {
+            disagree = 0;
+            for(int k = 0; k < batch->num_tasksets; k++) disagree += verdicts[k] != reference[k];
+        }
+        printf("batch kernel %s: %d tasksets (%lld tasks) in %.1f us, %.2f ns per task, %d verdicts differ from scalar\n",
+            batch_kernel_name(kernels[i]), batch->num_tasksets, total_tasks, per_round * 1e-3, per_round / total_tasks, disagree);
+    }
+
+    int counts[5] = {0};
+    for(int k = 0; k < batch->num_tasksets; k++)
+    {
+        for(int bit = 0; bit < 5; bit++) counts[bit] += (reference[k] >> bit) & 1;
+    }
+    printf("batch verdicts: U<=1 %d, RM Liu-Layland %d, RM hyperbolic %d, EDF density %d, EDF exact %d\n",
+        counts[0], counts[1], counts[2], counts[3], counts[4]);
+    free(reference);
+    free(verdicts);
+    free_TasksetBatch(batch);
+}
+
+int main(int argc, char* argv[])
+{
+    int sizes[] = {8, 32, 128, 512, 2048};
+    int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    sched_time_t horizon = argc > 1 ? atoll(argv[1]) : 20000;
+
+    TaskgenParams params;
+    taskgen_default_params(&params);
+    params.utilization = BENCH_UTILIZATION;
+    params.period_min = 100;
+    params.period_max = 100000;
+    params.deadline_ratio_min = 0.8;
+    params.deadline_ratio_max = 1.0;
+
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED);
+
+    printf("horizon %lld, U=%.2f, periods log-uniform in [%lld, %lld]\n", horizon, params.utilization, params.period_min, params.period_max);
+    printf("n\tpolicy\treleases\tdecisions\tevents/s\tns/decision\tpeak RSS kB\tanalysis us\n");
+    for(int i = 0; i < num_sizes; i++)
+    {
+        params.num_tasks = sizes[i];
+        int num_tasks = 0;
+        Task* tasks = generate_taskset(&params, &rng, &num_tasks);
+        if(tasks == NULL)
+        {
+            fprintf(stderr,"[ERROR]: could not draw a taskset with %d tasks\n",sizes[i]);
+            return -1;
+        }
+
+        for(int p = 0; p < NUM_BENCH_POLICIES; p++)
+        {
+            const BenchPolicy* policy = &bench_policies[p];
+            BenchResult result;
+            long peak_rss_kb = 0;
+            if(!measure_in_child(policy, tasks, num_tasks, horizon, &result, &peak_rss_kb))
+            {
+                fprintf(stderr,"[ERROR]: %s with %d tasks did not finish\n",policy->name,sizes[i]);
+                continue;
+            }
+
+            double events = result.releases + result.decisions;
+            printf("%d\t%s\t%lld\t\t%ld\t\t%.3g\t\t%.1f\t\t%ld\t\t", sizes[i], policy->name, result.releases, result.decisions,
+                events / (result.simulate_ns * 1e-9), result.simulate_ns / result.decisions, peak_rss_kb);
+            if(policy->analysis == BENCH_ANALYSIS_NONE) printf("-\n");
+            else printf("%.1f\n", result.analysis_ns * 1e-3);
+        }
+        free(tasks);
+    }
+
+    bench_admission(&params, &rng, 128);
+    bench_admission(&params, &rng, 2048);
+    bench_priority_assignment(&params, &rng, 128);
+    bench_priority_assignment(&params, &rng, 512);
+    bench_batch(&params, &rng);
+    bench_loading(&rng);
+    return 0;
+}
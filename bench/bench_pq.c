@@ -0,0 +1,141 @@
+#include "../include/task.h"
+#include "../include/priority_queue.h"
+#include "../include/job_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//microbenchmark of the heap ready queue against the sorted linked list it replaced
+//workload is the classic hold model: keep n jobs queued, then repeatedly pop the top and push a new job
+
+typedef struct list_node
+{
+    Job* data;
+    int priority;
+    struct list_node* nextnode;
+} ListNode;
+
+//the old sorted list push, kept verbatim as the baseline
+static ListNode* list_push(ListNode* Head, Job* data, int priority)
+{
+    ListNode* new = (ListNode*) malloc(sizeof(ListNode));
+    new->data = data;
+    new->priority = priority;
+    new->nextnode = NULL;
+
+    if(Head == NULL)
+    {
+        Head = new;
+    }
+    else if(Head->priority > new->priority)
+    {
+        new->nextnode = Head;
+        Head = new;
+    }
+    else
+    {
+        ListNode* cur = Head;
+        while(cur->nextnode != NULL && cur->nextnode->priority < new->priority)
+        {
+            cur = cur->nextnode;
+        }
+        new->nextnode = cur->nextnode;
+        cur->nextnode = new;
+    }
+    return Head;
+}
+
+static ListNode* list_pop(ListNode* Head)
+{
+    if (Head == NULL) return NULL;
+    ListNode* new_Head = Head->nextnode;
+    free(Head->data);
+    free(Head);
+    return new_Head;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static Job* new_job(void)
+{
+    return (Job*) calloc(1, sizeof(Job));
+}
+
+static double bench_list(int n, int operations, unsigned int seed)
+{
+    srand(seed);
+    ListNode* Head = NULL;
+    int clock = 0;
+    for(int i = 0; i < n; i++)
+    {
+        Head = list_push(Head, new_job(), rand() % n);
+    }
+
+    double start = now_ns();
+    for(int i = 0; i < operations; i++)
+    {
+        clock = Head->priority;
+        Head = list_pop(Head);
+        Head = list_push(Head, new_job(), clock + rand() % n);
+    }
+    double elapsed = now_ns() - start;
+
+    while(Head != NULL)
+    {
+        Head = list_pop(Head);
+    }
+    return elapsed / operations;
+}
+
+//with a pool both the jobs and the heap nodes are recycled instead of going through malloc
+static Job* next_job(JobPool* pool)
+{
+    return pool != NULL ? job_pool_alloc_job(pool) : new_job();
+}
+
+static double bench_heap(int n, int operations, unsigned int seed, bool pooled)
+{
+    srand(seed);
+    JobPool* pool = pooled ? new_JobPool() : NULL;
+    PriorityQueue* queue = new_PriorityQueue(pool);
+    int clock = 0;
+    for(int i = 0; i < n; i++)
+    {
+        push(queue, next_job(pool), rand() % n);
+    }
+
+    double start = now_ns();
+    for(int i = 0; i < operations; i++)
+    {
+        clock = peek_node(queue)->priority;
+        pop(queue);
+        push(queue, next_job(pool), clock + rand() % n);
+    }
+    double elapsed = now_ns() - start;
+
+    free_PriorityQueue(queue);
+    free_JobPool(pool);
+    return elapsed / operations;
+}
+
+int main(int argc, char* argv[])
+{
+    int sizes[] = {16, 128, 1024, 4096, 16384};
+    int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    int operations = argc > 1 ? atoi(argv[1]) : 20000;
+
+    printf("n\tlist ns/op\theap ns/op\tpooled ns/op\tspeedup\n");
+    for(int i = 0; i < num_sizes; i++)
+    {
+        double list = bench_list(sizes[i], operations, 42);
+        double heap = bench_heap(sizes[i], operations, 42, false);
+        double pooled = bench_heap(sizes[i], operations, 42, true);
+        printf("%d\t%.1f\t\t%.1f\t\t%.1f\t\t%.1fx\n", sizes[i], list, heap, pooled, list / pooled);
+    }
+    return 0;
+}
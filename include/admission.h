@@ -0,0 +1,44 @@
+#pragma once
+#include <stdbool.h>
+#include "task.h"
+#include "analysis.h"
+
+//which exact test admits a task
+typedef enum admission_test
+{
+    ADMISSION_FIXED_PRIORITY,
+    ADMISSION_EDF
+} AdmissionTest;
+
+//the admitted taskset plus the analysis state that makes a single add / remove cheap to judge
+//tasks are kept densely from highest to lowest priority, ids[] and the per level state run parallel to them:
+//demand: C_i + sum over higher levels of ceil(D_i / T_j) * C_j, exact, moved by O(1) per level on every change
+//first: a lower bound on the completion of the level's first job, 0 when nothing is known
+//wcrt: the level's exact response time, -1 until someone needs it
+typedef struct admission_control
+{
+    AdmissionTest test;
+    PriorityOrdering ordering;
+    Task* tasks;
+    int* ids;
+    sched_time_t* demand;
+    sched_time_t* first;
+    sched_time_t* wcrt;
+    sched_time_t* scratch_first;
+    sched_time_t* scratch_wcrt;
+    int num_tasks;
+    int capacity;
+    int next_id;
+    int constrained;
+    int removals;
+    double utilization;
+    double hyperbolic;
+} AdmissionControl;
+
+
+AdmissionControl* new_AdmissionControl(AdmissionTest test, PriorityOrdering ordering);
+void free_AdmissionControl(AdmissionControl* control);
+bool admission_can_add(AdmissionControl* control, const Task* task);
+int admission_add(AdmissionControl* control, const Task* task);
+bool admission_remove(AdmissionControl* control, int id);
+sched_time_t admission_response_time(AdmissionControl* control, int id);
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdbool.h>
+#include "task.h"
+
+//how fixed priorities are handed out, shorter period / deadline means higher priority
+typedef enum priority_ordering
+{
+    PRIORITY_RATE_MONOTONIC,
+    PRIORITY_DEADLINE_MONOTONIC
+} PriorityOrdering;
+
+//which kind of scheduler a feasibility interval is worked out for
+typedef enum feasibility_policy
+{
+    FEASIBILITY_FIXED_PRIORITY,
+    FEASIBILITY_EDF
+} FeasibilityPolicy;
+
+//what the limited preemption analyses charge besides the tasks' own work, arrays are indexed by task
+//preemption_cost: paid once per job release that can preempt, the engines add it to the job that resumes
+//threshold: fixed priority level (0 highest) a job has to be above to preempt a started job of the task, NULL: its own level
+//non_preemptive: floating non-preemptive region of every task, NULL: none
+typedef struct preemption_model
+{
+    sched_time_t preemption_cost;
+    const int* threshold;
+    const sched_time_t* non_preemptive;
+} PreemptionModel;
+
+void priority_order(Task tasks[], int num_tasks, PriorityOrdering ordering, int order[]);
+sched_time_t level_response_time(Task tasks[], const int order[], int level, sched_time_t start, sched_time_t* first_completion);
+bool response_time_analysis(Task tasks[], int num_tasks, const int order[], sched_time_t wcrt[]);
+bool optimal_priority_order(Task tasks[], int num_tasks, int order[], sched_time_t wcrt[]);
+bool edf_demand_analysis(Task tasks[], int num_tasks, sched_time_t* failing_interval);
+sched_time_t feasibility_interval(Task tasks[], int num_tasks, FeasibilityPolicy policy, const int order[], const char** basis);
+bool limited_preemption_analysis(Task tasks[], int num_tasks, const int order[], const PreemptionModel* model, sched_time_t wcrt[]);
+bool edf_limited_analysis(Task tasks[], int num_tasks, const PreemptionModel* model, sched_time_t* failing_interval);
+bool assign_preemption_thresholds(Task tasks[], int num_tasks, const int order[], sched_time_t preemption_cost, int threshold[]);
+bool fixed_priority_region_lengths(Task tasks[], int num_tasks, const int order[], sched_time_t preemption_cost, sched_time_t region[]);
+bool edf_region_lengths(Task tasks[], int num_tasks, sched_time_t preemption_cost, sched_time_t region[]);
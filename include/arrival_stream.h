@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "task.h"
+
+//one recorded job: the task it belongs to, when it was released and how long it actually ran
+typedef struct arrival
+{
+    int task_id;
+    sched_time_t release_time;
+    sched_time_t execution_time;
+} Arrival;
+
+//a recorded arrival trace read front to back through a fixed read ahead window,
+//one "task_id release_time execution_time" line per job, releases in non decreasing order,
+//blank lines and lines starting with '#' are skipped
+//memory stays at the window no matter how long the trace is
+typedef struct arrival_stream
+{
+    char* path;
+    int fd;
+    int num_tasks;
+    char* window;
+    size_t capacity;
+    size_t start;
+    size_t end;
+    bool eof;
+    bool failed;
+    long long line;
+    bool pending;
+    Arrival next;
+    long long replayed;
+} ArrivalStream;
+
+
+ArrivalStream* open_arrival_stream(const char* path, int num_tasks, size_t read_ahead);
+void close_arrival_stream(ArrivalStream* stream);
+bool rewind_arrival_stream(ArrivalStream* stream);
+sched_time_t next_arrival_time(ArrivalStream* stream, sched_time_t horizon);
+bool pop_due_arrival(ArrivalStream* stream, sched_time_t time, Arrival* arrival);
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <stdio.h>
+#include "task.h"
+
+int run_batch(const char* source, int num_threads, sched_time_t horizon, sched_time_t cap, FILE* out);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "task.h"
+
+//many tasksets back to back in one structure of arrays, for screening generated tasksets in bulk
+//taskset k owns slots [offset[k], offset[k] + padded) of the parameter arrays, every taskset starts on a
+//BATCH_LANES boundary and is padded up to one with neutral tasks (C = 0, T = D = 1), so the kernels need no tail
+//parameters are kept as doubles, converted once when a taskset is added
+#define BATCH_LANES 4
+
+typedef struct taskset_batch
+{
+    int num_tasksets;
+    int capacity;
+    int* num_tasks;
+    long long* offset;
+    long long slots;
+    long long slot_capacity;
+    double* execution_time;
+    double* period;
+    double* deadline;
+    double* liu_layland;
+    int max_tasks;
+} TasksetBatch;
+
+//one bit per test a taskset passes, all of them sufficient unless stated otherwise
+//BATCH_UTILIZATION: U <= 1, necessary under every policy
+//BATCH_RM_LIU_LAYLAND: no deadline before its period and U <= n(2^(1/n) - 1)
+//BATCH_RM_HYPERBOLIC: no deadline before its period and prod(U_i + 1) <= 2
+//BATCH_EDF_DENSITY: sum of C_i / min(D_i, T_i) <= 1
+//BATCH_EDF_EXACT: no deadline before its period and U <= 1, exact for EDF (and LLF)
+typedef enum batch_verdict
+{
+    BATCH_UTILIZATION = 1 << 0,
+    BATCH_RM_LIU_LAYLAND = 1 << 1,
+    BATCH_RM_HYPERBOLIC = 1 << 2,
+    BATCH_EDF_DENSITY = 1 << 3,
+    BATCH_EDF_EXACT = 1 << 4
+} BatchVerdict;
+
+//which kernel runs the batch, AUTO takes the widest one the cpu has
+//every kernel sums in the same lane order, so they all give bit for bit the same results
+typedef enum batch_kernel
+{
+    BATCH_KERNEL_AUTO,
+    BATCH_KERNEL_SCALAR,
+    BATCH_KERNEL_SSE2,
+    BATCH_KERNEL_AVX2
+} BatchKernel;
+
+
+TasksetBatch* new_TasksetBatch(int capacity);
+void free_TasksetBatch(TasksetBatch* batch);
+int taskset_batch_add(TasksetBatch* batch, const Task tasks[], int num_tasks);
+BatchKernel batch_kernel_available(BatchKernel kernel);
+const char* batch_kernel_name(BatchKernel kernel);
+BatchKernel analyse_taskset_batch(const TasksetBatch* batch, BatchKernel kernel, uint8_t verdicts[], double utilization[]);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <math.h>
+#include "task.h"
+#include "rng.h"
+
+//how a job's actual execution time is drawn, every shape is relative to its task's WCET C
+//WCET: always C, the periodic engines' default
+//uniform: evenly over [low * C, C]
+//normal: mean * C with standard deviation spread * C, clamped to [1, C]
+//bimodal: C with probability high, low * C otherwise (a rare slow path over a common fast one)
+typedef enum execution_distribution
+{
+    EXECUTION_WCET,
+    EXECUTION_UNIFORM,
+    EXECUTION_NORMAL,
+    EXECUTION_BIMODAL
+} ExecutionDistribution;
+
+typedef struct execution_model
+{
+    ExecutionDistribution distribution;
+    double low;
+    double mean;
+    double spread;
+    double high;
+} ExecutionModel;
+
+//a model plus the generator of one run, a sampler is never shared between runs running at the same time
+typedef struct execution_sampler
+{
+    ExecutionModel model;
+    Rng rng;
+} ExecutionSampler;
+
+//actual execution time of one job of a task with the given WCET, always in [1, wcet]
+static inline sched_time_t sample_execution_time(ExecutionSampler* sampler, sched_time_t wcet)
+{
+    const ExecutionModel* model = &sampler->model;
+    sched_time_t value;
+    switch(model->distribution)
+    {
+        case EXECUTION_UNIFORM:
+        {
+            sched_time_t low = (sched_time_t) ceil(model->low * wcet);
+            if(low < 1) low = 1;
+            value = low + (sched_time_t) rng_below(&sampler->rng, (uint64_t)(wcet - low + 1));
+            break;
+        }
+        case EXECUTION_NORMAL:
+            value = (sched_time_t) llround((model->mean + model->spread * rng_normal(&sampler->rng)) * wcet);
+            break;
+        case EXECUTION_BIMODAL:
+            value = rng_uniform(&sampler->rng) < model->high ? wcet : (sched_time_t) ceil(model->low * wcet);
+            break;
+        default:
+            value = wcet;
+            break;
+    }
+    if(value < 1) value = 1;
+    return value < wcet ? value : wcet;
+}
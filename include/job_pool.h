@@ -0,0 +1,39 @@
+#pragma once
+
+#include "task.h"
+#include "priority_queue.h"
+#include <stddef.h>
+
+//number of objects carved out of every slab
+#define POOL_SLAB_OBJECTS 256
+
+typedef struct slab
+{
+    struct slab* next;
+} Slab;
+
+//fixed size object allocator, freed objects are threaded onto a free list and reused
+typedef struct object_pool
+{
+    size_t object_size;
+    void* free_list;
+    Slab* slabs;
+    long live;
+    long peak_live;
+    long capacity;
+} ObjectPool;
+
+//jobs and queue nodes used by one scheduler run, released together by free_JobPool
+typedef struct job_pool
+{
+    ObjectPool jobs;
+    ObjectPool nodes;
+} JobPool;
+
+
+JobPool* new_JobPool(void);
+void free_JobPool(JobPool* pool);
+Job* job_pool_alloc_job(JobPool* pool);
+void job_pool_free_job(JobPool* pool, Job* job);
+Node* job_pool_alloc_node(JobPool* pool);
+void job_pool_free_node(JobPool* pool, Node* node);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "task.h"
+
+//log2 buckets: bucket 0 holds values <= 0, bucket k holds [2^(k-1), 2^k)
+#define HISTOGRAM_BUCKETS 64
+
+typedef struct histogram
+{
+    long long buckets[HISTOGRAM_BUCKETS];
+    long long count;
+    sched_time_t max;
+} Histogram;
+
+//everything known about a job once it completes (or is still pending when the run ends)
+//task is the job's index in the taskset of the run (as in Job), task_id the id the taskset names it by (as in Taskset)
+//completion is -1 for a job that never finished, start is -1 for one that never ran
+typedef struct job_record
+{
+    int task;
+    int task_id;
+    long long instance;
+    sched_time_t release;
+    sched_time_t start;
+    sched_time_t completion;
+    sched_time_t deadline;
+    long preemptions;
+    long migrations;
+} JobRecord;
+
+typedef void (*job_consumer)(const JobRecord* record, void* context);
+
+//per task totals, response times and start delays are over completed jobs
+//the start delay of a job is first start - release, its spread over the task's jobs is the start time jitter
+//(not release jitter: the periodic and replay engines release every job on time)
+typedef struct task_metrics
+{
+    long long completed;
+    long long missed;
+    long long unfinished;
+    long long preemptions;
+    long long migrations;
+    sched_time_t min_response;
+    sched_time_t max_response;
+    double total_response;
+    sched_time_t max_lateness;
+    sched_time_t min_start_delay;
+    sched_time_t max_start_delay;
+} TaskMetrics;
+
+//collected while a scheduler runs, O(1) per event and no timeline is kept
+//tasks[] is indexed by position in the taskset (Job.task), not by task_id, on_job (may be NULL) sees every job
+//record as it is produced, first_miss is the first job that completed late (task -1 until there is one),
+//with stop_at_miss set the engines end the run right at that completion
+//overhead is the execution the engines added for preemptions and migrations, see Taskset
+typedef struct metrics
+{
+    int num_tasks;
+    TaskMetrics* tasks;
+    long long context_switches;
+    sched_time_t overhead;
+    Histogram response;
+    Histogram tardiness;
+    job_consumer on_job;
+    void* context;
+    bool stop_at_miss;
+    JobRecord first_miss;
+} Metrics;
+
+
+void metrics_init(Metrics* metrics, int num_tasks);
+void metrics_free(Metrics* metrics);
+void metrics_record_job(Metrics* metrics, const Taskset* taskset, const Job* job, sched_time_t completion);
+void metrics_record_unfinished(Metrics* metrics, const Taskset* taskset, const Job* job, sched_time_t horizon);
+void metrics_record_preemption(Metrics* metrics, Job* job);
+void metrics_record_migration(Metrics* metrics, Job* job);
+void histogram_add(Histogram* histogram, sched_time_t value);
+sched_time_t histogram_percentile(const Histogram* histogram, double percentile);
+long long metrics_total_missed(const Metrics* metrics);
+long long metrics_total_preemptions(const Metrics* metrics);
+void print_metrics(const Metrics* metrics, FILE* out);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "task.h"
+#include "sched_new.h"
+#include "execution_sampler.h"
+
+//percentiles of the response time every replication works out exactly, per task
+#define MONTE_CARLO_PERCENTILES 3
+extern const double monte_carlo_percentiles[MONTE_CARLO_PERCENTILES];
+
+//replication r draws from a generator seeded with seed + r, so results do not depend on the thread count
+typedef struct monte_carlo_params
+{
+    ExecutionModel model;
+    int replications;
+    unsigned long long seed;
+    sched_time_t horizon;
+    int num_threads;
+} MonteCarloParams;
+
+//mean over the replications and the half width of its 95% confidence interval
+typedef struct estimate
+{
+    double mean;
+    double half_width;
+} Estimate;
+
+//jobs: judged jobs over every replication, completed ones plus pending ones already past their deadline
+//miss: fraction of a replication's judged jobs that missed
+//response[k]: a replication's monte_carlo_percentiles[k] percentile over its completed jobs
+typedef struct task_estimate
+{
+    long long jobs;
+    long long missed;
+    Estimate miss;
+    Estimate response[MONTE_CARLO_PERCENTILES];
+    sched_time_t max_response;
+} TaskEstimate;
+
+//failed_runs: replications with at least one miss, run_miss is their fraction with a Wilson score interval
+typedef struct monte_carlo_result
+{
+    int num_tasks;
+    int replications;
+    int failed_runs;
+    double run_miss;
+    double run_miss_low;
+    double run_miss_high;
+    TaskEstimate* tasks;
+} MonteCarloResult;
+
+
+bool parse_execution_model(const char* spec, ExecutionModel* model);
+void describe_execution_model(const ExecutionModel* model, char* text, size_t size);
+void monte_carlo(const Taskset* taskset, sampled_fn scheduler, const MonteCarloParams* params, MonteCarloResult* result);
+void free_MonteCarloResult(MonteCarloResult* result);
+void print_monte_carlo(const MonteCarloResult* result, FILE* out);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h>
+#include "task.h"
+#include "timeline.h"
+#include "sched_new.h"
+
+//bin packing heuristics, tasks are always placed in order of decreasing utilization
+typedef enum partition_heuristic
+{
+    PARTITION_FIRST_FIT,
+    PARTITION_BEST_FIT,
+    PARTITION_WORST_FIT
+} PartitionHeuristic;
+
+//the uniprocessor test a core has to pass after taking a task
+//RM uses exact response time analysis, EDF exact processor demand analysis (which also covers LLF)
+typedef enum partition_test
+{
+    PARTITION_TEST_RM,
+    PARTITION_TEST_EDF
+} PartitionTest;
+
+//task to core assignment, core_of[] is indexed by task index and holds -1 for a task no core could take
+typedef struct partition
+{
+    int num_tasks;
+    int num_cores;
+    int* core_of;
+    int* core_tasks;
+    double* core_utilization;
+    int unassigned;
+} Partition;
+
+//per core simulation time next to the wall clock time of running all cores in parallel
+typedef struct partition_timing
+{
+    double wall_us;
+    double serial_us;
+    double* core_us;
+} PartitionTiming;
+
+
+bool partition_tasks(Task tasks[], int num_tasks, PartitionHeuristic heuristic, PartitionTest test, int max_cores, Partition* partition);
+void free_Partition(Partition* partition);
+void simulate_partitioned(Task tasks[], int num_tasks, const Partition* partition, scheduler_fn scheduler, sched_time_t horizon,
+                          int num_threads, Timeline timelines[], PartitionTiming* timing);
@@ -2,18 +2,41 @@
 
 #include "task.h"
 #include <stdbool.h>
+
+struct job_pool;
+
+//a node is the handle returned by push, it stays valid until the job is popped or removed
 typedef struct node
 {
     Job* data;
-    int priority;
-    struct node* nextnode;
+    sched_time_t priority;
+    unsigned long sequence;
+    int index;
 } Node;
 
+//array backed binary min heap, ties on priority are broken by insertion order (FIFO)
+//nodes and popped jobs go back to the pool when one is given, otherwise to malloc/free
+typedef struct priority_queue
+{
+    struct job_pool* pool;
+    Node** heap;
+    int size;
+    int capacity;
+    unsigned long next_sequence;
+} PriorityQueue;
 
-Node* new_Node(Job* data, int priority);
-Node* push(Node* Head, Job* data, int priority);
-Job* peek(Node* Head);
-Node* pop(Node* Head);
-bool isEmpty(Node* Head);
-Node* rebuild_with_laxity(Node* Head, int current_time);
 
+PriorityQueue* new_PriorityQueue(struct job_pool* pool);
+void free_PriorityQueue(PriorityQueue* queue);
+Node* new_Node(struct job_pool* pool, Job* data, sched_time_t priority);
+Node* push(PriorityQueue* queue, Job* data, sched_time_t priority);
+Job* peek(PriorityQueue* queue);
+Node* peek_node(PriorityQueue* queue);
+Node* peek_second_node(PriorityQueue* queue);
+void pop(PriorityQueue* queue);
+Job* pop_job(PriorityQueue* queue, unsigned long* sequence);
+Node* requeue(PriorityQueue* queue, Job* data, sched_time_t priority, unsigned long sequence);
+bool isEmpty(PriorityQueue* queue);
+void decrease_key(PriorityQueue* queue, Node* handle, sched_time_t priority);
+void increase_key(PriorityQueue* queue, Node* handle, sched_time_t priority);
+void remove_node(PriorityQueue* queue, Node* handle);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "task.h"
+
+//min heap of task indices keyed on the run's next release of each task, ties go to the lower task index
+//so a batch of simultaneous releases comes out in the same order as a scan of the taskset
+typedef struct release_queue
+{
+    sched_time_t* next_release;
+    const sched_time_t* period;
+    int* heap;
+    int size;
+} ReleaseQueue;
+
+
+ReleaseQueue* new_ReleaseQueue(RunContext* context);
+void free_ReleaseQueue(ReleaseQueue* queue);
+sched_time_t next_release_time(ReleaseQueue* queue, sched_time_t horizon);
+int pop_due_releases(ReleaseQueue* queue, sched_time_t time, int released[]);
+void schedule_release(ReleaseQueue* queue, int task);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+
+//xoshiro256** generator, small enough to keep one per thread / per replication
+//seeded through splitmix64 so nearby seeds still give unrelated streams
+typedef struct rng
+{
+    uint64_t s[4];
+} Rng;
+
+static inline uint64_t rng_rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline void rng_seed(Rng* rng, uint64_t seed)
+{
+    for(int i = 0; i < 4; i++)
+    {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        rng->s[i] = z ^ (z >> 31);
+    }
+}
+
+static inline uint64_t rng_next(Rng* rng)
+{
+    uint64_t* s = rng->s;
+    uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rng_rotl(s[3], 45);
+    return result;
+}
+
+//uniform double in [0, 1) built from the top 53 bits
+static inline double rng_uniform(Rng* rng)
+{
+    return (rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//uniform integer in [0, bound), multiply and keep the high half, no division
+static inline uint64_t rng_below(Rng* rng, uint64_t bound)
+{
+    return (uint64_t)(((unsigned __int128) rng_next(rng) * bound) >> 64);
+}
+
+//standard normal by Box-Muller, the second value of the pair is dropped so the state stays a single Rng
+static inline double rng_normal(Rng* rng)
+{
+    double u = 1.0 - rng_uniform(rng);
+    double v = rng_uniform(rng);
+    return sqrt(-2.0 * log(u)) * cos(6.283185307179586 * v);
+}
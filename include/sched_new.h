@@ -1,9 +1,53 @@
 #pragma once
 #include "task.h"
+#include "timeline.h"
+#include "metrics.h"
+#include "arrival_stream.h"
+#include "execution_sampler.h"
 
-void rate_monotonic_scheduler(Task tasks[], int num_tasks, int timeline[][2]);
-void earliest_deadline_first_scheduler(Task tasks[], int num_tasks, int timeline[][2]);
-void least_laxity_first(Task tasks[], int num_tasks, int timeline[][2]);
+typedef void (*scheduler_fn)(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
 
+//what one core of a global run went through
+//a preemption is counted on the core the job was pushed off, a migration on the core the job moved to
+typedef struct core_stats
+{
+    long long preemptions;
+    long long migrations;
+    sched_time_t busy_time;
+} CoreStats;
 
+typedef void (*global_scheduler_fn)(const Taskset* taskset, int num_cores, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics);
 
+void rate_monotonic_scheduler(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void deadline_monotonic_scheduler(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void fixed_priority_scheduler(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void earliest_deadline_first_scheduler(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void fifo_scheduler(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void least_laxity_first(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void global_rate_monotonic_scheduler(const Taskset* taskset, int num_cores, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics);
+void global_deadline_monotonic_scheduler(const Taskset* taskset, int num_cores, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics);
+void global_earliest_deadline_first_scheduler(const Taskset* taskset, int num_cores, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics);
+
+//replay a recorded arrival trace through the same policies
+typedef void (*replay_fn)(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+typedef void (*global_replay_fn)(const Taskset* taskset, int num_cores, ArrivalStream* arrivals, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics);
+
+void rate_monotonic_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void deadline_monotonic_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void fixed_priority_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void earliest_deadline_first_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void fifo_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void least_laxity_first_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void global_rate_monotonic_replay(const Taskset* taskset, int num_cores, ArrivalStream* arrivals, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics);
+void global_deadline_monotonic_replay(const Taskset* taskset, int num_cores, ArrivalStream* arrivals, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics);
+void global_earliest_deadline_first_replay(const Taskset* taskset, int num_cores, ArrivalStream* arrivals, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics);
+
+//periodic releases with drawn execution times, see execution_sampler.h
+typedef void (*sampled_fn)(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+
+void rate_monotonic_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void deadline_monotonic_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void fixed_priority_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void earliest_deadline_first_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void fifo_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
+void least_laxity_first_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdbool.h>
+#include "task.h"
+
+//the exact test every probe runs
+//RM uses response time analysis, EDF processor demand analysis (which also covers LLF, optimal on one cpu like EDF)
+typedef enum sensitivity_test
+{
+    SENSITIVITY_TEST_RM,
+    SENSITIVITY_TEST_EDF
+} SensitivityTest;
+
+//headroom of a taskset under one test
+//scaling: the critical scaling factor, largest alpha such that every C_i -> ceil(alpha * C_i) stays schedulable,
+//below 1 when the taskset already fails, 0 when not even the smallest execution times fit
+//max_execution[] (indexed by task index): largest C_i that is schedulable with every other task unchanged, 0 when none is
+typedef struct sensitivity
+{
+    int num_tasks;
+    double scaling;
+    sched_time_t* max_execution;
+} Sensitivity;
+
+
+bool sensitivity_analysis(Task tasks[], int num_tasks, SensitivityTest test, int num_threads, double precision, Sensitivity* result);
+void free_Sensitivity(Sensitivity* sensitivity);
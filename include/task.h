@@ -1,19 +1,68 @@
 #pragma once
 
+#include <limits.h>
+
+//all times are 64 bit so long hyperperiods and horizons do not wrap around
+typedef long long sched_time_t;
+#define SCHED_TIME_MAX LLONG_MAX
+
+//a task's static parameters as they are read, written and analysed
 typedef struct task {
     int task_id;
-    int arrival_time;
-    int period;
-    int execution_time;
-    int relative_deadline;
-    int next_arrival_time;
-    int instance_counter;
+    sched_time_t arrival_time;
+    sched_time_t period;
+    sched_time_t execution_time;
+    sched_time_t relative_deadline;
 } Task;
 
+//the same parameters as a read only structure of arrays, what the engines simulate from
+//never written once built, so any number of runs can share one, concurrently included
+//task_id is the name a task is logged under, index i of every array is task i of the run
+//priority is what the fixed priority engines key on, lower runs first: the period (rate monotonic)
+//unless assign_priorities set an explicit order before any run started
+//preemption_cost / migration_cost: what the platform charges a job each time it resumes after a preemption /
+//on another core, added to its remaining execution, 0 for free context switches
+//preemption_threshold: a started job is queued with its task's threshold (a key, lower preempts less) from then on,
+//so only jobs keyed below it preempt it, NULL for fully preemptive; meant for task level fixed priority keys
+//non_preemptive_region: floating non-preemptive regions, a running job asked to give way keeps the cpu for up to
+//its task's region length more, NULL for none
+//the limited preemption arrays are only honoured by the uniprocessor engines, and are NULL unless a run
+//points a copy of the taskset at arrays it owns
+typedef struct taskset {
+    int num_tasks;
+    int* task_id;
+    sched_time_t* arrival_time;
+    sched_time_t* period;
+    sched_time_t* execution_time;
+    sched_time_t* relative_deadline;
+    sched_time_t* priority;
+    sched_time_t preemption_cost;
+    sched_time_t migration_cost;
+    sched_time_t* preemption_threshold;
+    sched_time_t* non_preemptive_region;
+} Taskset;
+
+//what one run changes per task, every simulation has its own
+//sampler draws the actual execution time of every periodic job, NULL runs each one for its WCET
+typedef struct run_context {
+    const Taskset* taskset;
+    sched_time_t* next_release;
+    long long* instances;
+    struct execution_sampler* sampler;
+} RunContext;
+
 
+//task is the job's index in the taskset of the run that released it
 typedef struct job {
-    Task* job_task;
-    int actual_execution_time;
-    int absolute_deadline;
-    int remaining_execution_time;
-} Job;
\ No newline at end of file
+    int task;
+    long long instance;
+    sched_time_t release_time;
+    sched_time_t actual_execution_time;
+    sched_time_t absolute_deadline;
+    sched_time_t remaining_execution_time;
+    sched_time_t start_time;
+    sched_time_t preemptable_at;
+    long preemptions;
+    long migrations;
+    int last_core;
+} Job;
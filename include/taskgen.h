@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdbool.h>
+#include "task.h"
+#include "rng.h"
+
+typedef enum taskgen_method
+{
+    TASKGEN_UUNIFAST,
+    TASKGEN_RANDFIXEDSUM
+} TaskgenMethod;
+
+//knobs of the synthetic taskset generator
+//periods are log-uniform in [period_min, period_max] and rounded to period_granularity
+//with a hyperperiod_limit every period is snapped to a divisor of it, so the hyperperiod never exceeds it
+//relative deadlines are period * r with r uniform in [deadline_ratio_min, deadline_ratio_max], never below C
+typedef struct taskgen_params
+{
+    int num_tasks;
+    double utilization;
+    TaskgenMethod method;
+    sched_time_t period_min;
+    sched_time_t period_max;
+    sched_time_t period_granularity;
+    sched_time_t hyperperiod_limit;
+    double deadline_ratio_min;
+    double deadline_ratio_max;
+} TaskgenParams;
+
+
+void taskgen_default_params(TaskgenParams* params);
+bool uunifast(Rng* rng, int n, double utilization, double out[]);
+bool randfixedsum(Rng* rng, int n, double utilization, double out[]);
+Task* generate_taskset(const TaskgenParams* params, Rng* rng, int* num_tasks);
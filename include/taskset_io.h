@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "task.h"
+
+//binary taskset: a fixed header followed by num_tasks records laid out exactly like Task,
+//so a mapped file can be used in place, version 2 records hold only the static parameters
+#define TASKSET_MAGIC "RTTASKS"
+#define TASKSET_VERSION 2
+#define TASKSET_BYTE_ORDER 0x01020304u
+
+typedef struct taskset_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t record_size;
+    uint32_t header_size;
+    uint64_t num_tasks;
+    uint8_t reserved[32];
+} TasksetHeader;
+
+//a binary taskset mapped copy on write, tasks points into the mapping and may be modified freely
+typedef struct taskset_map
+{
+    Task* tasks;
+    int num_tasks;
+    void* mapping;
+    size_t length;
+} TasksetMap;
+
+
+Task* load_taskset(const char* path, int* num_tasks);
+Task* load_taskset_text(const char* path, int* num_tasks);
+Task* load_taskset_binary(const char* path, int* num_tasks);
+bool map_taskset_binary(const char* path, TasksetMap* map);
+void unmap_taskset(TasksetMap* map);
+bool write_taskset(FILE* file, Task tasks[], int num_tasks);
+bool write_taskset_binary(FILE* file, Task tasks[], int num_tasks);
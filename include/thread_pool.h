@@ -0,0 +1,45 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+
+typedef void (*work_fn)(void* arg);
+
+typedef struct work_item
+{
+    work_fn fn;
+    void* arg;
+} WorkItem;
+
+//growable ring of work items owned by one worker, the owner takes from the front, thieves from the back
+typedef struct work_deque
+{
+    WorkItem* items;
+    int head;
+    int count;
+    int capacity;
+    pthread_mutex_t lock;
+} WorkDeque;
+
+//fixed set of worker threads, each with its own deque
+//submitted work is spread round robin and idle workers steal from the busiest end of the others
+typedef struct thread_pool
+{
+    pthread_t* threads;
+    WorkDeque* deques;
+    int num_threads;
+    int next_deque;
+    long queued;
+    long pending;
+    bool shutting_down;
+    pthread_mutex_t lock;
+    pthread_cond_t work_available;
+    pthread_cond_t all_done;
+} ThreadPool;
+
+
+int default_thread_count(void);
+ThreadPool* new_ThreadPool(int num_threads);
+void thread_pool_submit(ThreadPool* pool, work_fn fn, void* arg);
+void thread_pool_wait(ThreadPool* pool);
+void free_ThreadPool(ThreadPool* pool);
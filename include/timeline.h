@@ -0,0 +1,36 @@
+#pragma once
+
+#include "task.h"
+
+//one run of the cpu on the same job (or idle) over [start, end)
+//idle stretches use task_id = job_instance = -1
+typedef struct segment
+{
+    sched_time_t start;
+    sched_time_t end;
+    int task_id;
+    long long job_instance;
+} Segment;
+
+typedef void (*segment_consumer)(const Segment* segment, void* context);
+
+//compact schedule log, one entry per scheduling decision instead of one per time unit
+//buffered timelines keep every segment, streaming timelines hand them to a consumer
+//and never hold more than the buffer size
+//decisions counts every append, merged or not, i.e. the scheduler's decision points
+typedef struct timeline
+{
+    Segment* segments;
+    int count;
+    int capacity;
+    segment_consumer consumer;
+    void* context;
+    long decisions;
+} Timeline;
+
+
+void timeline_init(Timeline* timeline);
+void timeline_init_stream(Timeline* timeline, int buffer_segments, segment_consumer consumer, void* context);
+void timeline_append(Timeline* timeline, sched_time_t start, sched_time_t end, int task_id, long long job_instance);
+void timeline_flush(Timeline* timeline);
+void timeline_free(Timeline* timeline);
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "task.h"
+
+//what happened at a decision point, value depends on the type:
+//rekey: the job's new key, miss: how late the job completed, migrate: the core it came from
+typedef enum trace_type
+{
+    TRACE_RELEASE,
+    TRACE_DISPATCH,
+    TRACE_PREEMPT,
+    TRACE_COMPLETE,
+    TRACE_MISS,
+    TRACE_REKEY,
+    TRACE_MIGRATE
+} TraceType;
+
+//fixed size binary record, 32 bytes
+typedef struct trace_record
+{
+    sched_time_t time;
+    long long instance;
+    long long value;
+    int32_t task_id;
+    int16_t core;
+    uint8_t type;
+    uint8_t reserved;
+} TraceRecord;
+
+//single producer single consumer ring, the simulating thread writes and never blocks,
+//records that find the ring full are dropped and counted, capacity is a power of two
+typedef struct trace_buffer
+{
+    TraceRecord* records;
+    size_t mask;
+    size_t head;
+    size_t tail;
+    long long dropped;
+} TraceBuffer;
+
+//drains a buffer into a chrome trace / perfetto json file on its own thread while the run goes on
+typedef struct trace_exporter
+{
+    TraceBuffer* buffer;
+    FILE* out;
+    pthread_t thread;
+    bool stopping;
+    bool first_event;
+    long long exported;
+    sched_time_t last_time;
+    int num_cores;
+    struct open_slice* slices;
+} TraceExporter;
+
+//the buffer the current thread's scheduler runs write to, NULL when tracing is off
+extern __thread TraceBuffer* trace_current;
+
+//hooks in the engines compile to nothing unless built with -DSCHED_TRACE (make TRACE=1)
+#ifdef SCHED_TRACE
+#define TRACE_EVENT(type, time, taskset, job, core, value) \
+    do { if(trace_current != NULL) trace_emit(trace_current, (type), (time), (taskset), (job), (core), (value)); } while(0)
+#define TRACE_ENABLED 1
+#else
+#define TRACE_EVENT(type, time, taskset, job, core, value) ((void)0)
+#define TRACE_ENABLED 0
+#endif
+
+//records name the job's task by its taskset id, like the timelines do
+static inline void trace_emit(TraceBuffer* buffer, TraceType type, sched_time_t time, const Taskset* taskset, const Job* job, int core, long long value)
+{
+    size_t head = __atomic_load_n(&buffer->head, __ATOMIC_RELAXED);
+    size_t tail = __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE);
+    if(head - tail > buffer->mask)
+    {
+        __atomic_add_fetch(&buffer->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    TraceRecord* record = &buffer->records[head & buffer->mask];
+    record->time = time;
+    record->instance = job->instance;
+    record->value = value;
+    record->task_id = taskset->task_id[job->task];
+    record->core = (int16_t) core;
+    record->type = (uint8_t) type;
+    record->reserved = 0;
+    __atomic_store_n(&buffer->head, head + 1, __ATOMIC_RELEASE);
+}
+
+
+TraceBuffer* new_TraceBuffer(size_t capacity);
+void free_TraceBuffer(TraceBuffer* buffer);
+size_t trace_drain(TraceBuffer* buffer, TraceRecord out[], size_t max_records);
+bool trace_export_start(TraceExporter* exporter, TraceBuffer* buffer, FILE* out);
+long long trace_export_stop(TraceExporter* exporter, sched_time_t end);
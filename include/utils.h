@@ -2,10 +2,18 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include "task.h"
+#include "job_pool.h"
+#include "timeline.h"
 
-bool schedulability(Task tasks[], int num_tasks, char _type);
-int calculate_hyperperiod(Task tasks[], int num_tasks);
-void plot_timeline(int schedule_log[][2], int total_time);
-Task* clone_tasks_array(Task* tasks, int n);
+bool schedulability(Task tasks[], int num_tasks, char _type, const int opa_order[]);
+sched_time_t calculate_hyperperiod(Task tasks[], int num_tasks);
+sched_time_t simulation_horizon(Task tasks[], int num_tasks, sched_time_t horizon, sched_time_t cap);
+void plot_timeline(Timeline* timeline);
+void plot_segment(const Segment* segment, void* context);
+Taskset* new_Taskset(const Task tasks[], int num_tasks);
+void free_Taskset(Taskset* taskset);
+void assign_priorities(Taskset* taskset, const int order[]);
+void init_run_context(RunContext* context, const Taskset* taskset);
+void free_run_context(RunContext* context);
 void print_taskset(Task tasks[], int num_tasks);
-Job* allocate_job(Task* task, int cur_time);
\ No newline at end of file
+Job* allocate_job(JobPool* pool, const Taskset* taskset, int task, long long instance, sched_time_t cur_time);
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include "../include/admission.h"
+#include <stdlib.h>
+#include <string.h>
+
+//utilization sums are floating point, anything this close to a bound is decided by the exact test instead
+#define ADMISSION_EPSILON 1e-9
+
+//removals between two recomputations of the running sums from scratch, bounds the rounding drift
+#define ADMISSION_RESYNC 1024
+
+AdmissionControl* new_AdmissionControl(AdmissionTest test, PriorityOrdering ordering)
+{
+    AdmissionControl* control = (AdmissionControl*) calloc(1, sizeof(AdmissionControl));
+    control->test = test;
+    control->ordering = ordering;
+    control->hyperbolic = 1;
+    return control;
+}
+
+void free_AdmissionControl(AdmissionControl* control)
+{
+    if(control == NULL) return;
+    free(control->tasks);
+    free(control->ids);
+    free(control->demand);
+    free(control->first);
+    free(control->wcrt);
+    free(control->scratch_first);
+    free(control->scratch_wcrt);
+    free(control);
+}
+
+static inline double utilization_of(const Task* task)
+{
+    return (double) task->execution_time / task->period;
+}
+
+static inline sched_time_t priority_key(const AdmissionControl* control, const Task* task)
+{
+    return control->ordering == PRIORITY_DEADLINE_MONOTONIC ? task->relative_deadline : task->period;
+}
+
+static inline sched_time_t ceil_div(sched_time_t a, sched_time_t b)
+{
+    return (a + b - 1) / b;
+}
+
+//work a higher priority task puts into the window up to a level's deadline
+static inline sched_time_t interference(const Task* level, const Task* higher)
+{
+    return ceil_div(level->relative_deadline, higher->period) * higher->execution_time;
+}
+
+//level a new task takes, after every admitted task with the same key
+static int insertion_level(const AdmissionControl* control, const Task* task)
+{
+    sched_time_t key = priority_key(control, task);
+    int low = 0;
+    int high = control->num_tasks;
+    while(low < high)
+    {
+        int mid = (low + high) / 2;
+        if(priority_key(control, &control->tasks[mid]) <= key) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+//make room for task at level, only the task's own level state is filled in
+static void insert_level(AdmissionControl* control, int level, const Task* task, int id)
+{
+    if(control->num_tasks == control->capacity)
+    {
+        control->capacity = control->capacity > 0 ? 2 * control->capacity : 16;
+        control->tasks = (Task*) realloc(control->tasks, control->capacity * sizeof(Task));
+        control->ids = (int*) realloc(control->ids, control->capacity * sizeof(int));
+        control->demand = (sched_time_t*) realloc(control->demand, control->capacity * sizeof(sched_time_t));
+        control->first = (sched_time_t*) realloc(control->first, control->capacity * sizeof(sched_time_t));
+        control->wcrt = (sched_time_t*) realloc(control->wcrt, control->capacity * sizeof(sched_time_t));
+        control->scratch_first = (sched_time_t*) realloc(control->scratch_first, control->capacity * sizeof(sched_time_t));
+        control->scratch_wcrt = (sched_time_t*) realloc(control->scratch_wcrt, control->capacity * sizeof(sched_time_t));
+    }
+    int moved = control->num_tasks - level;
+    memmove(&control->tasks[level + 1], &control->tasks[level], moved * sizeof(Task));
+    memmove(&control->ids[level + 1], &control->ids[level], moved * sizeof(int));
+    memmove(&control->demand[level + 1], &control->demand[level], moved * sizeof(sched_time_t));
+    memmove(&control->first[level + 1], &control->first[level], moved * sizeof(sched_time_t));
+    memmove(&control->wcrt[level + 1], &control->wcrt[level], moved * sizeof(sched_time_t));
+    control->num_tasks++;
+
+    control->tasks[level] = *task;
+    control->ids[level] = id;
+    control->demand[level] = task->execution_time;
+    for(int k = 0; k < level; k++)
+    {
+        control->demand[level] += interference(task, &control->tasks[k]);
+    }
+    control->first[level] = 0;
+    control->wcrt[level] = -1;
+}
+
+static void erase_level(AdmissionControl* control, int level)
+{
+    int moved = control->num_tasks - level - 1;
+    memmove(&control->tasks[level], &control->tasks[level + 1], moved * sizeof(Task));
+    memmove(&control->ids[level], &control->ids[level + 1], moved * sizeof(int));
+    memmove(&control->demand[level], &control->demand[level + 1], moved * sizeof(sched_time_t));
+    memmove(&control->first[level], &control->first[level + 1], moved * sizeof(sched_time_t));
+    memmove(&control->wcrt[level], &control->wcrt[level + 1], moved * sizeof(sched_time_t));
+    control->num_tasks--;
+}
+
+//exact response time of a level from the best lower bound on its first job at hand
+static sched_time_t analyse_level(AdmissionControl* control, int level, sched_time_t* first_completion)
+{
+    Task* task = &control->tasks[level];
+    sched_time_t start = (level > 0 ? control->first[level - 1] : 0) + task->execution_time;
+    if(control->first[level] > start) start = control->first[level];
+    return level_response_time(control->tasks, NULL, level, start, first_completion);
+}
+
+//with the new task already placed at level, check it and every level below into the scratch arrays
+//a level whose deadline is within its period and whose demand at the deadline fits is settled in O(1),
+//only the rest go through the fixed point, seeded with what was known before the task came (interference only grew)
+static bool check_levels(AdmissionControl* control, int level)
+{
+    const Task* added = &control->tasks[level];
+    for(int i = level; i < control->num_tasks; i++)
+    {
+        Task* task = &control->tasks[i];
+        sched_time_t demand = control->demand[i] + (i > level ? interference(task, added) : 0);
+        if(demand <= task->relative_deadline && task->relative_deadline <= task->period)
+        {
+            control->scratch_first[i] = control->first[i];
+            control->scratch_wcrt[i] = -1;
+            continue;
+        }
+
+        sched_time_t response = analyse_level(control, i, &control->scratch_first[i]);
+        if(response > task->relative_deadline)
+        {
+            return false;
+        }
+        control->scratch_wcrt[i] = response;
+    }
+    return true;
+}
+
+//keep the new task at level, the levels below take its interference
+static void commit_level(AdmissionControl* control, int level, bool checked)
+{
+    const Task* added = &control->tasks[level];
+    for(int i = level; i < control->num_tasks; i++)
+    {
+        if(i > level) control->demand[i] += interference(&control->tasks[i], added);
+        if(checked)
+        {
+            control->first[i] = control->scratch_first[i];
+            control->wcrt[i] = control->scratch_wcrt[i];
+        }
+        else
+        {
+            control->wcrt[i] = -1;
+        }
+    }
+}
+
+//decide a new task and keep it when commit is set, the taskset is left as it was otherwise
+//order of checks: utilization above one rejects, then the closed form bounds, then the exact test on the affected levels only
+static bool judge_add(AdmissionControl* control, const Task* task, bool commit, int id)
+{
+    double u = utilization_of(task);
+    double utilization = control->utilization + u;
+    if(utilization > 1 + ADMISSION_EPSILON)
+    {
+        return false;
+    }
+
+    bool constrained = control->constrained > 0 || task->relative_deadline < task->period;
+    int level = insertion_level(control, task);
+    insert_level(control, level, task, id);
+
+    //U <= 1 is exact for EDF when no deadline is shorter than its period,
+    //and the hyperbolic bound prod(U_i + 1) <= 2 is sufficient for RM under the same condition
+    bool accepted;
+    bool checked = false;
+    if(control->test == ADMISSION_EDF)
+    {
+        accepted = (!constrained && utilization < 1 - ADMISSION_EPSILON) || edf_demand_analysis(control->tasks, control->num_tasks, NULL);
+    }
+    else if(control->ordering == PRIORITY_RATE_MONOTONIC && !constrained && control->hyperbolic * (u + 1) <= 2 - ADMISSION_EPSILON)
+    {
+        accepted = true;
+    }
+    else
+    {
+        accepted = check_levels(control, level);
+        checked = true;
+    }
+
+    if(!accepted || !commit)
+    {
+        erase_level(control, level);
+        return accepted;
+    }
+
+    commit_level(control, level, checked);
+    control->utilization = utilization;
+    control->hyperbolic *= u + 1;
+    if(task->relative_deadline < task->period) control->constrained++;
+    return true;
+}
+
+//would the admitted taskset stay schedulable with task added, nothing is changed
+bool admission_can_add(AdmissionControl* control, const Task* task)
+{
+    return judge_add(control, task, false, -1);
+}
+
+//admit task if the taskset stays schedulable with it, returns the id to remove it by or -1 when it is rejected
+int admission_add(AdmissionControl* control, const Task* task)
+{
+    if(!judge_add(control, task, true, control->next_id))
+    {
+        return -1;
+    }
+    return control->next_id++;
+}
+
+static void resync(AdmissionControl* control)
+{
+    control->utilization = 0;
+    control->hyperbolic = 1;
+    for(int level = 0; level < control->num_tasks; level++)
+    {
+        double u = utilization_of(&control->tasks[level]);
+        control->utilization += u;
+        control->hyperbolic *= u + 1;
+    }
+}
+
+//removing a task never breaks a schedulable taskset under either test, so this always succeeds for a known id
+//the levels below it lose its interference, their first job bounds and response times are dropped
+bool admission_remove(AdmissionControl* control, int id)
+{
+    int level = 0;
+    while(level < control->num_tasks && control->ids[level] != id) level++;
+    if(level == control->num_tasks)
+    {
+        return false;
+    }
+
+    Task* task = &control->tasks[level];
+    double u = utilization_of(task);
+    control->utilization -= u;
+    control->hyperbolic /= u + 1;
+    if(task->relative_deadline < task->period) control->constrained--;
+
+    for(int i = level + 1; i < control->num_tasks; i++)
+    {
+        control->demand[i] -= interference(&control->tasks[i], task);
+        control->first[i] = 0;
+        control->wcrt[i] = -1;
+    }
+    erase_level(control, level);
+
+    if(++control->removals % ADMISSION_RESYNC == 0)
+    {
+        resync(control);
+    }
+    return true;
+}
+
+//worst case response time of an admitted task under fixed priorities, -1 for an unknown id or under EDF
+//worked out on first use after a change that touched its level
+sched_time_t admission_response_time(AdmissionControl* control, int id)
+{
+    if(control->test != ADMISSION_FIXED_PRIORITY)
+    {
+        return -1;
+    }
+    int level = 0;
+    while(level < control->num_tasks && control->ids[level] != id) level++;
+    if(level == control->num_tasks)
+    {
+        return -1;
+    }
+
+    if(control->wcrt[level] < 0)
+    {
+        control->wcrt[level] = analyse_level(control, level, &control->first[level]);
+    }
+    return control->wcrt[level];
+}
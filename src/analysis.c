@@ -0,0 +1,842 @@
+#include "../include/analysis.h"
+#include "../include/utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+typedef struct ranked_task
+{
+    sched_time_t key;
+    int index;
+} RankedTask;
+
+static int compare_rank(const void* a, const void* b)
+{
+    const RankedTask* x = (const RankedTask*) a;
+    const RankedTask* y = (const RankedTask*) b;
+    if(x->key != y->key)
+    {
+        return x->key < y->key ? -1 : 1;
+    }
+    return x->index - y->index;
+}
+
+//fill order[] with task indices from highest to lowest priority, ties go to the lower index
+void priority_order(Task tasks[], int num_tasks, PriorityOrdering ordering, int order[])
+{
+    RankedTask* ranked = (RankedTask*) malloc(num_tasks * sizeof(RankedTask));
+    for(int i = 0; i < num_tasks; i++)
+    {
+        ranked[i].key = ordering == PRIORITY_DEADLINE_MONOTONIC ? tasks[i].relative_deadline : tasks[i].period;
+        ranked[i].index = i;
+    }
+    qsort(ranked, num_tasks, sizeof(RankedTask), compare_rank);
+    for(int i = 0; i < num_tasks; i++)
+    {
+        order[i] = ranked[i].index;
+    }
+    free(ranked);
+}
+
+static inline sched_time_t ceil_div(sched_time_t a, sched_time_t b)
+{
+    return (a + b - 1) / b;
+}
+
+//smallest fixed point of w = own + sum over higher priority tasks of ceil(w / T_j) * C_j
+//starting from a known lower bound, gives up as soon as w passes the limit
+static sched_time_t busy_window(Task tasks[], const int order[], int level, sched_time_t own, sched_time_t start, sched_time_t limit)
+{
+    sched_time_t w = start;
+    while(true)
+    {
+        sched_time_t demand = own;
+        for(int k = 0; k < level; k++)
+        {
+            Task* hp = &tasks[order != NULL ? order[k] : k];
+            demand += ceil_div(w, hp->period) * hp->execution_time;
+        }
+        if(demand == w || demand > limit)
+        {
+            return demand;
+        }
+        w = demand;
+    }
+}
+
+//worst case response time of the task at one priority level, order[] as in response_time_analysis
+//or NULL when tasks[] is already sorted from highest to lowest priority
+//start is a lower bound on the completion of the level's first job, first_completion gets that completion
+//stops as soon as a job passes the deadline, the result then only is a lower bound above the deadline
+//deadlines beyond the period are handled by checking every job in the level-i busy period
+sched_time_t level_response_time(Task tasks[], const int order[], int level, sched_time_t start, sched_time_t* first_completion)
+{
+    Task* task = &tasks[order != NULL ? order[level] : level];
+    sched_time_t deadline = task->relative_deadline;
+    sched_time_t response = 0;
+    sched_time_t w = start;
+
+    for(long long q = 0; ; q++)
+    {
+        w = busy_window(tasks, order, level, (q + 1) * task->execution_time, w, q * task->period + deadline);
+        if(q == 0 && first_completion != NULL)
+        {
+            *first_completion = w;
+        }
+
+        sched_time_t job_response = w - q * task->period;
+        if(job_response > response)
+        {
+            response = job_response;
+        }
+
+        //deadline passed or the busy period closed before the next job of this task arrived
+        if(response > deadline || w <= (q + 1) * task->period)
+        {
+            return response;
+        }
+
+        //the next job can not finish before this one plus its own execution
+        w += task->execution_time;
+    }
+}
+
+//exact response time analysis for fixed priority preemptive scheduling with synchronous releases
+//order[] lists task indices from highest to lowest priority, wcrt[] is indexed by task index
+//a task whose iteration passes its deadline stops early, its wcrt then only holds that lower bound
+bool response_time_analysis(Task tasks[], int num_tasks, const int order[], sched_time_t wcrt[])
+{
+    bool schedulable = true;
+
+    //completion of the first job at the previous level, R_(i-1) + C_i is a valid start for level i
+    sched_time_t previous_first = 0;
+
+    for(int level = 0; level < num_tasks; level++)
+    {
+        Task* task = &tasks[order[level]];
+        sched_time_t response = level_response_time(tasks, order, level, previous_first + task->execution_time, &previous_first);
+
+        wcrt[order[level]] = response;
+        if(response > task->relative_deadline)
+        {
+            schedulable = false;
+        }
+    }
+
+    return schedulable;
+}
+
+//Audsley's optimal priority assignment, driven by the exact response time analysis above
+//fills the levels from the lowest up, each with a task that meets its deadline below every task still unplaced,
+//so a feasible fixed priority order is found whenever one exists, deadlines beyond the period included
+//order[] gets task indices from highest to lowest priority, wcrt[] (may be NULL) is indexed by task index
+//on failure the levels left unfilled hold the unplaced tasks in deadline monotonic order
+bool optimal_priority_order(Task tasks[], int num_tasks, int order[], sched_time_t wcrt[])
+{
+    //unplaced tasks stay in order[0..level] in deadline monotonic order, the longest deadline is tried first
+    //so whenever deadline monotonic is already feasible every level is filled by its first candidate
+    priority_order(tasks, num_tasks, PRIORITY_DEADLINE_MONOTONIC, order);
+
+    //every unplaced task releases a job at 0, so no candidate's first job completes before all of them ran
+    sched_time_t demand = 0;
+    double utilization = 0;
+    for(int i = 0; i < num_tasks; i++)
+    {
+        demand += tasks[i].execution_time;
+        utilization += (double) tasks[i].execution_time / tasks[i].period;
+    }
+
+    for(int level = num_tasks - 1; level >= 0; level--)
+    {
+        int placed = -1;
+        sched_time_t response = 0;
+        for(int j = level; j >= 0 && placed < 0; j--)
+        {
+            Task* task = &tasks[order[j]];
+            if(demand > task->relative_deadline)
+            {
+                continue;
+            }
+
+            //the rest of the unplaced tasks take their utilization of any window, so the first job needs at
+            //least C / (1 - U_rest), skipped when U_rest is too close to 1 for the division to be trusted
+            double share = (double) task->execution_time / task->period;
+            double rest = utilization - share;
+            sched_time_t start = demand;
+            if(rest < 1 - 1e-6)
+            {
+                double bound = task->execution_time / (1 - rest) * (1 - 1e-9);
+                if(bound > (double) task->relative_deadline)
+                {
+                    continue;
+                }
+                if(bound > (double) start) start = (sched_time_t) bound;
+            }
+
+            //the interference of the other unplaced tasks does not depend on their order, the candidate
+            //is swapped onto the level being filled for the test and back again
+            int candidate = order[j];
+            order[j] = order[level];
+            order[level] = candidate;
+            response = level_response_time(tasks, order, level, start, NULL);
+            order[level] = order[j];
+            order[j] = candidate;
+
+            if(response <= task->relative_deadline)
+            {
+                placed = j;
+            }
+        }
+
+        if(placed < 0)
+        {
+            if(wcrt != NULL)
+            {
+                response_time_analysis(tasks, num_tasks, order, wcrt);
+            }
+            return false;
+        }
+
+        //the tasks above keep their relative order, the placed task's response time is final:
+        //the set of tasks above it no longer changes, so no second pass of the analysis is needed
+        int chosen = order[placed];
+        memmove(&order[placed], &order[placed + 1], (level - placed) * sizeof(int));
+        order[level] = chosen;
+        demand -= tasks[chosen].execution_time;
+        utilization -= (double) tasks[chosen].execution_time / tasks[chosen].period;
+        if(wcrt != NULL)
+        {
+            wcrt[chosen] = response;
+        }
+    }
+    return true;
+}
+
+//demand bound function: work of all jobs released and due inside [0, t] under synchronous release
+static sched_time_t demand_bound(Task tasks[], int num_tasks, sched_time_t t)
+{
+    sched_time_t demand = 0;
+    for(int i = 0; i < num_tasks; i++)
+    {
+        if(tasks[i].relative_deadline <= t)
+        {
+            demand += ((t - tasks[i].relative_deadline) / tasks[i].period + 1) * tasks[i].execution_time;
+        }
+    }
+    return demand;
+}
+
+//largest absolute deadline strictly before t, or -1 if there is none
+static sched_time_t deadline_before(Task tasks[], int num_tasks, sched_time_t t)
+{
+    sched_time_t latest = -1;
+    for(int i = 0; i < num_tasks; i++)
+    {
+        if(tasks[i].relative_deadline < t)
+        {
+            sched_time_t k = (t - 1 - tasks[i].relative_deadline) / tasks[i].period;
+            sched_time_t deadline = k * tasks[i].period + tasks[i].relative_deadline;
+            if(deadline > latest)
+            {
+                latest = deadline;
+            }
+        }
+    }
+    return latest;
+}
+
+//length of the synchronous busy period, -1 once it passes limit or stops fitting in 64 bits
+//it is only finite when utilization <= 1, and then never longer than the hyperperiod
+static sched_time_t synchronous_busy_period(Task tasks[], int num_tasks, sched_time_t limit)
+{
+    sched_time_t w = 0;
+    for(int i = 0; i < num_tasks; i++)
+    {
+        w += tasks[i].execution_time;
+    }
+    while(true)
+    {
+        sched_time_t demand = 0;
+        for(int i = 0; i < num_tasks; i++)
+        {
+            sched_time_t work;
+            if(__builtin_mul_overflow(ceil_div(w, tasks[i].period), tasks[i].execution_time, &work) ||
+               __builtin_add_overflow(demand, work, &demand))
+            {
+                return -1;
+            }
+        }
+        if(demand == w)
+        {
+            return w;
+        }
+        if(demand > limit)
+        {
+            return -1;
+        }
+        w = demand;
+    }
+}
+
+typedef struct pending_deadline
+{
+    sched_time_t deadline;
+    int task;
+} PendingDeadline;
+
+static void sift_deadline(PendingDeadline heap[], int size, int index)
+{
+    PendingDeadline item = heap[index];
+    while(true)
+    {
+        int child = 2 * index + 1;
+        if(child >= size) break;
+        if(child + 1 < size && heap[child + 1].deadline < heap[child].deadline) child++;
+        if(heap[child].deadline >= item.deadline) break;
+        heap[index] = heap[child];
+        index = child;
+    }
+    heap[index] = item;
+}
+
+static PendingDeadline* deadline_heap(Task tasks[], int num_tasks)
+{
+    PendingDeadline* heap = (PendingDeadline*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(PendingDeadline));
+    for(int i = 0; i < num_tasks; i++)
+    {
+        heap[i].deadline = tasks[i].relative_deadline;
+        heap[i].task = i;
+    }
+    for(int i = num_tasks / 2 - 1; i >= 0; i--)
+    {
+        sift_deadline(heap, num_tasks, i);
+    }
+    return heap;
+}
+
+//move on to the next absolute deadline, every job due at that instant adds its execution to demand
+static sched_time_t next_deadline(PendingDeadline heap[], Task tasks[], int num_tasks, sched_time_t* demand)
+{
+    sched_time_t t = heap[0].deadline;
+    while(heap[0].deadline == t)
+    {
+        Task* task = &tasks[heap[0].task];
+        *demand += task->execution_time;
+        heap[0].deadline += task->period;
+        sift_deadline(heap, num_tasks, 0);
+    }
+    return t;
+}
+
+//walk the absolute deadlines in increasing order up to limit and return the first one where demand exceeds it
+static sched_time_t first_failing_deadline(Task tasks[], int num_tasks, sched_time_t limit)
+{
+    PendingDeadline* heap = deadline_heap(tasks, num_tasks);
+    sched_time_t failing = limit;
+    sched_time_t demand = 0;
+    while(heap[0].deadline <= limit)
+    {
+        sched_time_t t = next_deadline(heap, tasks, num_tasks, &demand);
+        if(demand > t)
+        {
+            failing = t;
+            break;
+        }
+    }
+
+    free(heap);
+    return failing;
+}
+
+//exact EDF test for synchronous tasks with arbitrary deadlines, quick processor-demand analysis (QPA)
+//the check runs backwards from the tighter of the busy period and the utilization based bound,
+//jumping straight to h(t) whenever there is slack, so only a handful of points are ever evaluated
+//on rejection failing_interval is set to the first t with h(t) > t
+bool edf_demand_analysis(Task tasks[], int num_tasks, sched_time_t* failing_interval)
+{
+    double utilization = 0;
+    double slack_weight = 0;
+    sched_time_t max_deadline = 0;
+    sched_time_t min_deadline = SCHED_TIME_MAX;
+    for(int i = 0; i < num_tasks; i++)
+    {
+        double u = (double)tasks[i].execution_time / tasks[i].period;
+        utilization += u;
+        slack_weight += (double)(tasks[i].period - tasks[i].relative_deadline) * u;
+        if(tasks[i].relative_deadline > max_deadline) max_deadline = tasks[i].relative_deadline;
+        if(tasks[i].relative_deadline < min_deadline) min_deadline = tasks[i].relative_deadline;
+    }
+
+    if(num_tasks == 0) return true;
+
+    //overloaded: demand overtakes the interval once U * t - sum(U_i * D_i) > t
+    if(utilization > 1)
+    {
+        double weighted_deadlines = 0;
+        for(int i = 0; i < num_tasks; i++)
+        {
+            weighted_deadlines += (double)tasks[i].relative_deadline * tasks[i].execution_time / tasks[i].period;
+        }
+        sched_time_t limit = (sched_time_t) ceil(weighted_deadlines / (utilization - 1)) + 1;
+        if(limit < max_deadline) limit = max_deadline;
+        if(failing_interval != NULL) *failing_interval = first_failing_deadline(tasks, num_tasks, limit);
+        return false;
+    }
+
+    //the busy period is only worked out while it can still beat the utilization based bound,
+    //close to U = 1 it takes far more iterations than it could save
+    sched_time_t bound = SCHED_TIME_MAX - 1;
+    if(utilization < 1)
+    {
+        double weighted_slack = slack_weight / (1 - utilization);
+        if(weighted_slack < (double) bound)
+        {
+            bound = weighted_slack > max_deadline ? (sched_time_t) ceil(weighted_slack) : max_deadline;
+        }
+    }
+    sched_time_t busy_period = synchronous_busy_period(tasks, num_tasks, bound);
+    if(busy_period >= 0 && busy_period < bound) bound = busy_period;
+
+    sched_time_t t = deadline_before(tasks, num_tasks, bound + 1);
+    if(t < 0) return true;
+
+    sched_time_t demand = demand_bound(tasks, num_tasks, t);
+    while(demand <= t && demand > min_deadline)
+    {
+        t = demand < t ? demand : deadline_before(tasks, num_tasks, t);
+        demand = demand_bound(tasks, num_tasks, t);
+    }
+
+    if(demand <= min_deadline)
+    {
+        return true;
+    }
+
+    if(failing_interval != NULL) *failing_interval = first_failing_deadline(tasks, num_tasks, t);
+    return false;
+}
+
+//shortest prefix [0, L) of the schedule that decides feasibility: no deadline missed in it means none is ever missed
+//a deadline at L itself is not judged by a run over [0, L), so the closed intervals of the offset bounds get one more unit
+//synchronous releases (every task starting at the same time): the synchronous busy period, for both policies
+//with offsets and every deadline within its period:
+//  fixed priorities, S_n + H (Goossens), S_1 = O_1, S_i = O_i + ceil(max(S_(i-1) - O_i, 0) / T_i) * T_i in priority order
+//  EDF, O_max + 2H (Leung and Merrill)
+//order[] lists task indices from highest to lowest priority (NULL when tasks[] already is), only fixed priorities use it
+//-1 when no interval is known: utilization above one, offsets with deadlines beyond periods, or 64 bit overflow
+//basis (may be NULL) gets which bound was used, or why there is none
+sched_time_t feasibility_interval(Task tasks[], int num_tasks, FeasibilityPolicy policy, const int order[], const char** basis)
+{
+    const char* unused;
+    if(basis == NULL) basis = &unused;
+    if(num_tasks == 0)
+    {
+        *basis = "empty taskset";
+        return 0;
+    }
+
+    sched_time_t hyperperiod = calculate_hyperperiod(tasks, num_tasks);
+    if(hyperperiod < 0)
+    {
+        *basis = "hyperperiod does not fit in 64 bits";
+        return -1;
+    }
+
+    //exact utilization test, sum of C_i * H / T_i against H
+    sched_time_t work = 0;
+    sched_time_t min_offset = SCHED_TIME_MAX;
+    sched_time_t max_offset = 0;
+    bool constrained = true;
+    for(int i = 0; i < num_tasks; i++)
+    {
+        sched_time_t task_work;
+        if(__builtin_mul_overflow(hyperperiod / tasks[i].period, tasks[i].execution_time, &task_work) ||
+           __builtin_add_overflow(work, task_work, &work) || work > hyperperiod)
+        {
+            *basis = "utilization above 1";
+            return -1;
+        }
+        if(tasks[i].arrival_time < min_offset) min_offset = tasks[i].arrival_time;
+        if(tasks[i].arrival_time > max_offset) max_offset = tasks[i].arrival_time;
+        if(tasks[i].relative_deadline > tasks[i].period) constrained = false;
+    }
+
+    sched_time_t interval;
+    if(min_offset == max_offset)
+    {
+        *basis = "synchronous busy period";
+        sched_time_t busy = synchronous_busy_period(tasks, num_tasks, hyperperiod);
+        if(busy < 0 || __builtin_add_overflow(min_offset, busy, &interval))
+        {
+            *basis = "busy period does not fit in 64 bits";
+            return -1;
+        }
+        return interval;
+    }
+
+    if(!constrained)
+    {
+        *basis = "offsets with deadlines beyond periods";
+        return -1;
+    }
+
+    if(policy == FEASIBILITY_EDF)
+    {
+        *basis = "Leung-Merrill bound O_max + 2H";
+        if(__builtin_mul_overflow(hyperperiod, 2, &interval) || __builtin_add_overflow(interval, max_offset + 1, &interval))
+        {
+            *basis = "Leung-Merrill bound does not fit in 64 bits";
+            return -1;
+        }
+        return interval;
+    }
+
+    *basis = "fixed priority bound S_n + H";
+    sched_time_t settled = 0;
+    for(int level = 0; level < num_tasks; level++)
+    {
+        Task* task = &tasks[order != NULL ? order[level] : level];
+        sched_time_t behind = settled > task->arrival_time ? settled - task->arrival_time : 0;
+        if(__builtin_mul_overflow(ceil_div(behind, task->period), task->period, &settled) ||
+           __builtin_add_overflow(settled, task->arrival_time, &settled))
+        {
+            *basis = "fixed priority bound does not fit in 64 bits";
+            return -1;
+        }
+    }
+    if(__builtin_add_overflow(settled, hyperperiod + 1, &interval))
+    {
+        *basis = "fixed priority bound does not fit in 64 bits";
+        return -1;
+    }
+    return interval;
+}
+
+//longest a job at the given level can be kept waiting by one lower priority job that started before its release:
+//all of that job when the level can not preempt it, its non-preemptive region when the level can
+static sched_time_t limited_blocking(Task tasks[], int num_tasks, const int order[], int level, const PreemptionModel* model)
+{
+    sched_time_t blocking = 0;
+    for(int l = level + 1; l < num_tasks; l++)
+    {
+        int j = order[l];
+        sched_time_t run = tasks[j].execution_time + model->preemption_cost;
+        sched_time_t wait = 0;
+        if(model->threshold != NULL && model->threshold[j] <= level)
+        {
+            wait = run;
+        }
+        else if(model->non_preemptive != NULL)
+        {
+            wait = model->non_preemptive[j] < run ? model->non_preemptive[j] : run;
+        }
+        if(wait > blocking)
+        {
+            blocking = wait;
+        }
+    }
+    return blocking;
+}
+
+//worst case response time of the task at one level under limited preemption, Wang and Saksena's analysis as
+//corrected by Regehr: before a job starts it waits for the blocking and every higher priority job released up to
+//its start, once started only tasks above its threshold get in, each higher priority job brings one preemption cost
+//every job of the level-i busy period is checked, stops at the first one past the deadline like level_response_time
+static sched_time_t limited_level_response(Task tasks[], const int order[], int level, const PreemptionModel* model, sched_time_t blocking)
+{
+    Task* task = &tasks[order[level]];
+    sched_time_t cost = model->preemption_cost;
+    int threshold = model->threshold != NULL ? model->threshold[order[level]] : level;
+    sched_time_t deadline = task->relative_deadline;
+
+    //the level-i busy period never closes once the inflated utilization passes 1, or reaches it with blocking
+    double utilization = (double) task->execution_time / task->period;
+    sched_time_t interference = 0;
+    for(int k = 0; k < level; k++)
+    {
+        Task* hp = &tasks[order[k]];
+        utilization += (double)(hp->execution_time + cost) / hp->period;
+        interference += hp->execution_time + cost;
+    }
+    if(utilization > 1 + 1e-9 || (blocking > 0 && utilization > 1 - 1e-12))
+    {
+        return deadline + 1;
+    }
+
+    sched_time_t busy = blocking + task->execution_time + interference;
+    while(true)
+    {
+        sched_time_t next = blocking + ceil_div(busy, task->period) * task->execution_time;
+        for(int k = 0; k < level; k++)
+        {
+            Task* hp = &tasks[order[k]];
+            next += ceil_div(busy, hp->period) * (hp->execution_time + cost);
+        }
+        if(next == busy)
+        {
+            break;
+        }
+        if(next > SCHED_TIME_MAX / 4)
+        {
+            return deadline + 1;
+        }
+        busy = next;
+    }
+
+    sched_time_t response = 0;
+    long long jobs = ceil_div(busy, task->period);
+    for(long long q = 0; q < jobs; q++)
+    {
+        sched_time_t release = q * task->period;
+        sched_time_t own = blocking + q * task->execution_time;
+        sched_time_t start = own + interference;
+        while(true)
+        {
+            sched_time_t next = own;
+            for(int k = 0; k < level; k++)
+            {
+                Task* hp = &tasks[order[k]];
+                next += (start / hp->period + 1) * (hp->execution_time + cost);
+            }
+            if(next == start)
+            {
+                break;
+            }
+            start = next;
+            if(start - release > deadline)
+            {
+                return start - release;
+            }
+        }
+
+        //releases strictly after the start and before the finish, of tasks above the threshold only
+        sched_time_t finish = start + task->execution_time;
+        while(true)
+        {
+            sched_time_t next = start + task->execution_time;
+            for(int k = 0; k < threshold; k++)
+            {
+                Task* hp = &tasks[order[k]];
+                next += (ceil_div(finish, hp->period) - start / hp->period - 1) * (hp->execution_time + cost);
+            }
+            if(next == finish)
+            {
+                break;
+            }
+            finish = next;
+            if(finish - release > deadline)
+            {
+                return finish - release;
+            }
+        }
+
+        if(finish - release > response)
+        {
+            response = finish - release;
+        }
+    }
+    return response;
+}
+
+//fixed priority response time analysis under limited preemption, order[] and wcrt[] as in response_time_analysis
+//with no cost, no thresholds and no non-preemptive regions it gives the same response times
+bool limited_preemption_analysis(Task tasks[], int num_tasks, const int order[], const PreemptionModel* model, sched_time_t wcrt[])
+{
+    bool schedulable = true;
+    for(int level = 0; level < num_tasks; level++)
+    {
+        sched_time_t blocking = limited_blocking(tasks, num_tasks, order, level, model);
+        sched_time_t response = limited_level_response(tasks, order, level, model, blocking);
+        wcrt[order[level]] = response;
+        if(response > tasks[order[level]].relative_deadline)
+        {
+            schedulable = false;
+        }
+    }
+    return schedulable;
+}
+
+//the tasks with the preemption cost folded into every job's execution, one preemption per release
+static Task* inflated_tasks(Task tasks[], int num_tasks, sched_time_t preemption_cost)
+{
+    Task* inflated = (Task*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(Task));
+    memcpy(inflated, tasks, num_tasks * sizeof(Task));
+    for(int i = 0; i < num_tasks; i++)
+    {
+        inflated[i].execution_time += preemption_cost;
+    }
+    return inflated;
+}
+
+//EDF processor demand analysis under limited preemption: every job carries the cost of the one preemption its
+//release can cause, and a deadline at t can also wait out the non-preemptive region of one job due after t,
+//so dbf(t) + max over D_j > t of q_j <= t at every absolute deadline (Baruah), thresholds do not apply to EDF
+//failing_interval as in edf_demand_analysis
+bool edf_limited_analysis(Task tasks[], int num_tasks, const PreemptionModel* model, sched_time_t* failing_interval)
+{
+    Task* inflated = inflated_tasks(tasks, num_tasks, model->preemption_cost);
+    bool schedulable = edf_demand_analysis(inflated, num_tasks, failing_interval);
+    if(!schedulable || model->non_preemptive == NULL || num_tasks == 0)
+    {
+        free(inflated);
+        return schedulable;
+    }
+
+    //blocking after a deadline t: the longest region of a task due after t, from a suffix maximum over deadlines
+    RankedTask* by_deadline = (RankedTask*) malloc(num_tasks * sizeof(RankedTask));
+    sched_time_t* later_region = (sched_time_t*) malloc((num_tasks + 1) * sizeof(sched_time_t));
+    for(int i = 0; i < num_tasks; i++)
+    {
+        by_deadline[i].key = tasks[i].relative_deadline;
+        by_deadline[i].index = i;
+    }
+    qsort(by_deadline, num_tasks, sizeof(RankedTask), compare_rank);
+    later_region[num_tasks] = 0;
+    for(int i = num_tasks - 1; i >= 0; i--)
+    {
+        Task* task = &inflated[by_deadline[i].index];
+        sched_time_t region = model->non_preemptive[by_deadline[i].index];
+        if(region > task->execution_time) region = task->execution_time;
+        later_region[i] = region > later_region[i + 1] ? region : later_region[i + 1];
+    }
+
+    //past the longest deadline nothing blocks, the check above covers it
+    PendingDeadline* heap = deadline_heap(inflated, num_tasks);
+    sched_time_t max_deadline = by_deadline[num_tasks - 1].key;
+    sched_time_t demand = 0;
+    int later = 0;
+    while(heap[0].deadline < max_deadline)
+    {
+        sched_time_t t = next_deadline(heap, inflated, num_tasks, &demand);
+        while(later < num_tasks && by_deadline[later].key <= t) later++;
+        if(demand + later_region[later] > t)
+        {
+            if(failing_interval != NULL) *failing_interval = t;
+            schedulable = false;
+            break;
+        }
+    }
+
+    free(heap);
+    free(later_region);
+    free(by_deadline);
+    free(inflated);
+    return schedulable;
+}
+
+//preemption thresholds as high as they go with every task still meeting its deadline (Saksena and Wang's greedy):
+//from the highest priority down, each task's threshold is raised one level at a time while the task at the new
+//level still makes it, raising a threshold over level l only adds a blocker to the task at l, nobody else changes
+//threshold[] is indexed by task and holds levels, false when some task misses with the final thresholds
+bool assign_preemption_thresholds(Task tasks[], int num_tasks, const int order[], sched_time_t preemption_cost, int threshold[])
+{
+    PreemptionModel model = { preemption_cost, threshold, NULL };
+    for(int level = 0; level < num_tasks; level++)
+    {
+        threshold[order[level]] = level;
+    }
+
+    for(int level = 1; level < num_tasks; level++)
+    {
+        int task = order[level];
+        while(threshold[task] > 0)
+        {
+            int above = threshold[task] - 1;
+            threshold[task] = above;
+            sched_time_t blocking = limited_blocking(tasks, num_tasks, order, above, &model);
+            if(limited_level_response(tasks, order, above, &model, blocking) > tasks[order[above]].relative_deadline)
+            {
+                threshold[task] = above + 1;
+                break;
+            }
+        }
+    }
+
+    sched_time_t* wcrt = (sched_time_t*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(sched_time_t));
+    bool schedulable = limited_preemption_analysis(tasks, num_tasks, order, &model, wcrt);
+    free(wcrt);
+    return schedulable;
+}
+
+//longest floating non-preemptive regions with fixed priorities still meeting every deadline: a region only
+//blocks higher levels, so q_k is C_k plus the cost capped by the blocking every level above it tolerates,
+//a level's tolerance is bisected over the limited preemption analysis
+//region[] is indexed by task, false (and every region 0) when the taskset misses even fully preemptive
+bool fixed_priority_region_lengths(Task tasks[], int num_tasks, const int order[], sched_time_t preemption_cost, sched_time_t region[])
+{
+    PreemptionModel model = { preemption_cost, NULL, NULL };
+    sched_time_t tolerated = SCHED_TIME_MAX;
+    for(int level = 0; level < num_tasks; level++)
+    {
+        Task* task = &tasks[order[level]];
+        sched_time_t run = task->execution_time + preemption_cost;
+        region[order[level]] = run < tolerated ? run : tolerated;
+
+        //largest blocking this level still meets its deadline with, found in [0, D]
+        sched_time_t low = 0;
+        sched_time_t high = task->relative_deadline;
+        if(limited_level_response(tasks, order, level, &model, 0) > task->relative_deadline)
+        {
+            for(int i = 0; i < num_tasks; i++) region[i] = 0;
+            return false;
+        }
+        while(low < high)
+        {
+            sched_time_t middle = low + (high - low + 1) / 2;
+            if(limited_level_response(tasks, order, level, &model, middle) <= task->relative_deadline) low = middle;
+            else high = middle - 1;
+        }
+        if(low < tolerated)
+        {
+            tolerated = low;
+        }
+    }
+    return true;
+}
+
+//longest floating non-preemptive regions with EDF still meeting every deadline: a region only delays deadlines
+//before the task's own, so q_k = min(C_k + cost, min over absolute deadlines t < D_k of t - dbf(t)) (Baruah)
+//region[] is indexed by task, false (and every region 0) when the taskset misses even fully preemptive
+bool edf_region_lengths(Task tasks[], int num_tasks, sched_time_t preemption_cost, sched_time_t region[])
+{
+    Task* inflated = inflated_tasks(tasks, num_tasks, preemption_cost);
+    if(num_tasks == 0 || !edf_demand_analysis(inflated, num_tasks, NULL))
+    {
+        for(int i = 0; i < num_tasks; i++) region[i] = 0;
+        free(inflated);
+        return num_tasks == 0;
+    }
+
+    RankedTask* by_deadline = (RankedTask*) malloc(num_tasks * sizeof(RankedTask));
+    for(int i = 0; i < num_tasks; i++)
+    {
+        by_deadline[i].key = tasks[i].relative_deadline;
+        by_deadline[i].index = i;
+    }
+    qsort(by_deadline, num_tasks, sizeof(RankedTask), compare_rank);
+
+    //every task's first deadline is itself a point of the walk, its region is settled right before that point counts
+    PendingDeadline* heap = deadline_heap(inflated, num_tasks);
+    sched_time_t slack = SCHED_TIME_MAX;
+    sched_time_t demand = 0;
+    int settled = 0;
+    while(settled < num_tasks)
+    {
+        sched_time_t t = next_deadline(heap, inflated, num_tasks, &demand);
+        while(settled < num_tasks && by_deadline[settled].key <= t)
+        {
+            int task = by_deadline[settled++].index;
+            region[task] = inflated[task].execution_time < slack ? inflated[task].execution_time : slack;
+        }
+        if(t - demand < slack)
+        {
+            slack = t - demand;
+        }
+    }
+
+    free(heap);
+    free(by_deadline);
+    free(inflated);
+    return true;
+}
@@ -0,0 +1,207 @@
+#include "../include/arrival_stream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+
+//smallest window, a line has to fit in it
+#define MIN_READ_AHEAD 4096
+
+//stop the replay at the first bad line, the jobs before it have been replayed already
+static bool stream_error(ArrivalStream* stream, const char* reason)
+{
+    fprintf(stderr,"[ERROR]: %s line %lld: %s, replay stops here\n",stream->path,stream->line,reason);
+    stream->failed = true;
+    stream->pending = false;
+    return false;
+}
+
+//move the unread tail to the front of the window and fill the rest from the file
+static bool refill(ArrivalStream* stream)
+{
+    size_t left = stream->end - stream->start;
+    memmove(stream->window, stream->window + stream->start, left);
+    stream->start = 0;
+    stream->end = left;
+    while(stream->end < stream->capacity)
+    {
+        ssize_t bytes = read(stream->fd, stream->window + stream->end, stream->capacity - stream->end);
+        if(bytes < 0)
+        {
+            fprintf(stderr,"[ERROR]: Error reading %s\n",stream->path);
+            stream->failed = true;
+            stream->eof = true;
+            return false;
+        }
+        if(bytes == 0)
+        {
+            stream->eof = true;
+            break;
+        }
+        stream->end += bytes;
+    }
+    return true;
+}
+
+//parse one unsigned number, false if there is none or it does not fit in 64 bits
+static bool parse_field(const char** cursor, const char* end, long long* value)
+{
+    const char* c = *cursor;
+    while(c < end && (*c == ' ' || *c == '\t' || *c == '\r')) c++;
+    if(c == end || *c < '0' || *c > '9')
+    {
+        return false;
+    }
+    long long number = 0;
+    while(c < end && *c >= '0' && *c <= '9')
+    {
+        if(number > (LLONG_MAX - (*c - '0')) / 10)
+        {
+            return false;
+        }
+        number = number * 10 + (*c - '0');
+        c++;
+    }
+    *cursor = c;
+    *value = number;
+    return true;
+}
+
+//read the next job into stream->next, false at the end of the trace or on a bad line
+static bool read_next(ArrivalStream* stream)
+{
+    sched_time_t previous = stream->pending ? stream->next.release_time : 0;
+    stream->pending = false;
+    while(!stream->failed)
+    {
+        char* line = stream->window + stream->start;
+        char* newline = (char*) memchr(line, '\n', stream->end - stream->start);
+        if(newline == NULL && !stream->eof)
+        {
+            if(stream->start == 0 && stream->end == stream->capacity)
+            {
+                stream->line++;
+                return stream_error(stream, "line longer than the read ahead window");
+            }
+            refill(stream);
+            continue;
+        }
+        if(newline == NULL && stream->start == stream->end)
+        {
+            return false;
+        }
+
+        char* line_end = newline != NULL ? newline : stream->window + stream->end;
+        stream->start = newline != NULL ? (size_t)(newline + 1 - stream->window) : stream->end;
+        stream->line++;
+
+        const char* cursor = line;
+        while(cursor < line_end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) cursor++;
+        if(cursor == line_end || *cursor == '#')
+        {
+            continue;
+        }
+
+        long long fields[3];
+        for(int f = 0; f < 3; f++)
+        {
+            if(!parse_field(&cursor, line_end, &fields[f]))
+            {
+                return stream_error(stream, "expected task_id release_time execution_time");
+            }
+        }
+        if(fields[0] >= stream->num_tasks)
+        {
+            return stream_error(stream, "task id is not in the taskset");
+        }
+        if(fields[1] < previous)
+        {
+            return stream_error(stream, "release goes back in time");
+        }
+        if(fields[2] <= 0)
+        {
+            return stream_error(stream, "execution time must be positive");
+        }
+
+        stream->next.task_id = (int) fields[0];
+        stream->next.release_time = fields[1];
+        stream->next.execution_time = fields[2];
+        stream->pending = true;
+        return true;
+    }
+    return false;
+}
+
+//open a trace of jobs of a num_tasks taskset, the file is read read_ahead bytes at a time
+//NULL (with the reason printed to stderr) if it can not be opened
+ArrivalStream* open_arrival_stream(const char* path, int num_tasks, size_t read_ahead)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        fprintf(stderr,"[ERROR]: Error opening %s\n",path);
+        return NULL;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    ArrivalStream* stream = (ArrivalStream*) calloc(1, sizeof(ArrivalStream));
+    stream->path = strdup(path);
+    stream->fd = fd;
+    stream->num_tasks = num_tasks;
+    stream->capacity = read_ahead > MIN_READ_AHEAD ? read_ahead : MIN_READ_AHEAD;
+    stream->window = (char*) malloc(stream->capacity);
+    read_next(stream);
+    return stream;
+}
+
+void close_arrival_stream(ArrivalStream* stream)
+{
+    if(stream == NULL) return;
+    close(stream->fd);
+    free(stream->window);
+    free(stream->path);
+    free(stream);
+}
+
+//start over from the first job, so the same trace can be replayed under another policy
+bool rewind_arrival_stream(ArrivalStream* stream)
+{
+    if(lseek(stream->fd, 0, SEEK_SET) != 0)
+    {
+        fprintf(stderr,"[ERROR]: %s can not be rewound\n",stream->path);
+        return false;
+    }
+    stream->start = stream->end = 0;
+    stream->eof = false;
+    stream->failed = false;
+    stream->line = 0;
+    stream->pending = false;
+    stream->replayed = 0;
+    read_next(stream);
+    return true;
+}
+
+//release time of the next job, horizon when the trace is done
+sched_time_t next_arrival_time(ArrivalStream* stream, sched_time_t horizon)
+{
+    if(!stream->pending || stream->next.release_time > horizon)
+    {
+        return horizon;
+    }
+    return stream->next.release_time;
+}
+
+//hand out the next job if it is released by time, call until false to get every due job
+bool pop_due_arrival(ArrivalStream* stream, sched_time_t time, Arrival* arrival)
+{
+    if(!stream->pending || stream->next.release_time > time)
+    {
+        return false;
+    }
+    *arrival = stream->next;
+    stream->replayed++;
+    read_next(stream);
+    return true;
+}
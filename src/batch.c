@@ -0,0 +1,286 @@
+#include "../include/batch.h"
+#include "../include/utils.h"
+#include "../include/taskset_io.h"
+#include "../include/sched_new.h"
+#include "../include/analysis.h"
+#include "../include/timeline.h"
+#include "../include/thread_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+
+//segments a run keeps in memory before handing them to the accounting consumer
+#define BATCH_TIMELINE_BUFFER 64
+
+typedef struct batch_policy
+{
+    const char* name;
+    scheduler_fn scheduler;
+} BatchPolicy;
+
+static const BatchPolicy batch_policies[] = {
+    { "RM", rate_monotonic_scheduler },
+    { "EDF", earliest_deadline_first_scheduler },
+    { "LLF", least_laxity_first },
+};
+#define NUM_BATCH_POLICIES ((int)(sizeof(batch_policies) / sizeof(batch_policies[0])))
+
+typedef struct batch_taskset
+{
+    char* path;
+    Task* tasks;
+    int num_tasks;
+    Taskset* taskset;
+} BatchTaskset;
+
+//one (taskset x policy) simulation, every field below the inputs is written only by the thread running it
+typedef struct batch_run
+{
+    BatchTaskset* taskset;
+    const BatchPolicy* policy;
+    sched_time_t horizon;
+    sched_time_t cap;
+    sched_time_t simulated;
+    sched_time_t busy_time;
+    long segments;
+    long long misses;
+    long long preemptions;
+    long long context_switches;
+    int verdict;
+    double wall_us;
+} BatchRun;
+
+static int compare_paths(const void* a, const void* b)
+{
+    return strcmp(*(char* const*) a, *(char* const*) b);
+}
+
+static void add_path(char*** paths, int* count, int* capacity, const char* path)
+{
+    if(*count == *capacity)
+    {
+        *capacity = *capacity > 0 ? 2 * *capacity : 64;
+        *paths = (char**) realloc(*paths, *capacity * sizeof(char*));
+    }
+    (*paths)[(*count)++] = strdup(path);
+}
+
+//a directory contributes every regular file in it (sorted), anything else is read as a manifest
+//with one taskset path per line, blank lines and lines starting with '#' are skipped
+//count is set to -1 when the source itself can not be read
+static char** collect_tasksets(const char* source, int* count)
+{
+    char** paths = NULL;
+    int capacity = 0;
+    *count = 0;
+
+    struct stat info;
+    if(stat(source, &info) != 0)
+    {
+        fprintf(stderr,"[ERROR]: Error opening %s\n",source);
+        *count = -1;
+        return NULL;
+    }
+
+    if(S_ISDIR(info.st_mode))
+    {
+        DIR* dir = opendir(source);
+        if(dir == NULL)
+        {
+            fprintf(stderr,"[ERROR]: Error opening %s\n",source);
+            *count = -1;
+            return NULL;
+        }
+        struct dirent* entry;
+        while((entry = readdir(dir)) != NULL)
+        {
+            if(entry->d_name[0] == '.') continue;
+            size_t length = strlen(source) + strlen(entry->d_name) + 2;
+            char* path = (char*) malloc(length);
+            snprintf(path, length, "%s/%s", source, entry->d_name);
+            if(stat(path, &info) == 0 && S_ISREG(info.st_mode))
+            {
+                add_path(&paths, count, &capacity, path);
+            }
+            free(path);
+        }
+        closedir(dir);
+        qsort(paths, *count, sizeof(char*), compare_paths);
+        return paths;
+    }
+
+    FILE* manifest = fopen(source, "r");
+    if(manifest == NULL)
+    {
+        fprintf(stderr,"[ERROR]: Error opening %s\n",source);
+        *count = -1;
+        return NULL;
+    }
+    char line[4096];
+    while(fgets(line, sizeof(line), manifest) != NULL)
+    {
+        char* start = line;
+        while(*start == ' ' || *start == '\t') start++;
+        char* end = start + strlen(start);
+        while(end > start && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) end--;
+        *end = '\0';
+        if(*start == '\0' || *start == '#') continue;
+        add_path(&paths, count, &capacity, start);
+    }
+    fclose(manifest);
+    return paths;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void load_work(void* arg)
+{
+    BatchTaskset* taskset = (BatchTaskset*) arg;
+    taskset->tasks = load_taskset(taskset->path, &taskset->num_tasks);
+    if(taskset->tasks != NULL)
+    {
+        taskset->taskset = new_Taskset(taskset->tasks, taskset->num_tasks);
+    }
+}
+
+//timeline consumer that only keeps the totals of a run
+static void account_segment(const Segment* segment, void* context)
+{
+    BatchRun* run = (BatchRun*) context;
+    run->segments++;
+    if(segment->task_id != -1)
+    {
+        run->busy_time += segment->end - segment->start;
+    }
+}
+
+//exact analysis matching the policy: RTA for RM, processor demand for EDF (which also decides LLF)
+static int analyse(Task tasks[], int num_tasks, const BatchPolicy* policy)
+{
+    if(policy->scheduler == rate_monotonic_scheduler)
+    {
+        int* order = (int*) malloc(num_tasks * sizeof(int));
+        sched_time_t* wcrt = (sched_time_t*) malloc(num_tasks * sizeof(sched_time_t));
+        priority_order(tasks, num_tasks, PRIORITY_RATE_MONOTONIC, order);
+        bool schedulable = response_time_analysis(tasks, num_tasks, order, wcrt);
+        free(order);
+        free(wcrt);
+        return schedulable;
+    }
+    return edf_demand_analysis(tasks, num_tasks, NULL);
+}
+
+//runs on a worker, every policy's run reads the same taskset at once, all it writes is its own
+static void simulate_work(void* arg)
+{
+    BatchRun* run = (BatchRun*) arg;
+    BatchTaskset* taskset = run->taskset;
+    double start = now_us();
+
+    run->verdict = analyse(taskset->tasks, taskset->num_tasks, run->policy);
+    run->simulated = simulation_horizon(taskset->tasks, taskset->num_tasks, run->horizon, run->cap);
+
+    Timeline timeline;
+    Metrics metrics;
+    timeline_init_stream(&timeline, BATCH_TIMELINE_BUFFER, account_segment, run);
+    metrics_init(&metrics, taskset->num_tasks);
+    run->policy->scheduler(taskset->taskset, run->simulated, &timeline, &metrics);
+    timeline_flush(&timeline);
+    timeline_free(&timeline);
+    run->misses = metrics_total_missed(&metrics);
+    run->preemptions = metrics_total_preemptions(&metrics);
+    run->context_switches = metrics.context_switches;
+    metrics_free(&metrics);
+
+    run->wall_us = now_us() - start;
+}
+
+//simulate every taskset named by source under every batch policy on a pool of num_threads workers
+//prints one tab separated summary line per run, in taskset then policy order, returns the number of runs
+int run_batch(const char* source, int num_threads, sched_time_t horizon, sched_time_t cap, FILE* out)
+{
+    int num_tasksets = 0;
+    char** paths = collect_tasksets(source, &num_tasksets);
+    if(num_tasksets < 0)
+    {
+        return -1;
+    }
+
+    double start = now_us();
+    ThreadPool* pool = new_ThreadPool(num_threads);
+
+    BatchTaskset* tasksets = (BatchTaskset*) calloc(num_tasksets > 0 ? num_tasksets : 1, sizeof(BatchTaskset));
+    for(int i = 0; i < num_tasksets; i++)
+    {
+        tasksets[i].path = paths[i];
+        thread_pool_submit(pool, load_work, &tasksets[i]);
+    }
+    thread_pool_wait(pool);
+
+    int num_runs = num_tasksets * NUM_BATCH_POLICIES;
+    BatchRun* runs = (BatchRun*) calloc(num_runs > 0 ? num_runs : 1, sizeof(BatchRun));
+    for(int i = 0; i < num_tasksets; i++)
+    {
+        for(int p = 0; p < NUM_BATCH_POLICIES; p++)
+        {
+            BatchRun* run = &runs[i * NUM_BATCH_POLICIES + p];
+            run->taskset = &tasksets[i];
+            run->policy = &batch_policies[p];
+            run->horizon = horizon;
+            run->cap = cap;
+            run->verdict = -1;
+            if(tasksets[i].tasks != NULL && tasksets[i].num_tasks > 0)
+            {
+                thread_pool_submit(pool, simulate_work, run);
+            }
+        }
+    }
+    thread_pool_wait(pool);
+    int workers = pool->num_threads;
+    free_ThreadPool(pool);
+
+    fprintf(out, "file\tpolicy\ttasks\tutilization\tanalysis\thorizon\tbusy\tidle\tsegments\tmisses\tpreemptions\tswitches\twall_us\n");
+    for(int i = 0; i < num_runs; i++)
+    {
+        BatchRun* run = &runs[i];
+        BatchTaskset* taskset = run->taskset;
+        if(run->verdict < 0)
+        {
+            fprintf(out, "%s\t%s\tload-error\n", taskset->path, run->policy->name);
+            continue;
+        }
+
+        double utilization = 0;
+        for(int t = 0; t < taskset->num_tasks; t++)
+        {
+            utilization += (double) taskset->tasks[t].execution_time / taskset->tasks[t].period;
+        }
+        fprintf(out, "%s\t%s\t%d\t%f\t%s\t%lld\t%lld\t%lld\t%ld\t%lld\t%lld\t%lld\t%.1f\n",
+            taskset->path, run->policy->name, taskset->num_tasks, utilization,
+            run->verdict ? "schedulable" : "unschedulable",
+            run->simulated, run->busy_time, run->simulated - run->busy_time, run->segments,
+            run->misses, run->preemptions, run->context_switches, run->wall_us);
+    }
+
+    double elapsed = (now_us() - start) / 1e6;
+    fprintf(stderr, "[BATCH]: %d runs over %d tasksets on %d threads in %.3fs (%.0f runs/s)\n",
+        num_runs, num_tasksets, workers, elapsed, elapsed > 0 ? num_runs / elapsed : 0.0);
+
+    for(int i = 0; i < num_tasksets; i++)
+    {
+        free_Taskset(tasksets[i].taskset);
+        free(tasksets[i].tasks);
+        free(tasksets[i].path);
+    }
+    free(tasksets);
+    free(paths);
+    free(runs);
+    return num_runs;
+}
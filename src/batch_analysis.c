@@ -0,0 +1,332 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/batch_analysis.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+//the arrays hand out BATCH_LANES doubles at a time, aligned so the vector kernels can use aligned loads
+#define BATCH_ALIGNMENT 32
+
+//what a kernel hands over for one taskset, its four lane partial sums already folded together
+typedef struct batch_sums
+{
+    double utilization;
+    double density;
+    double hyperbolic;
+    bool constrained;
+} BatchSums;
+
+static double* new_aligned(long long capacity)
+{
+    size_t bytes = (size_t) capacity * sizeof(double);
+    bytes = (bytes + BATCH_ALIGNMENT - 1) / BATCH_ALIGNMENT * BATCH_ALIGNMENT;
+    return (double*) aligned_alloc(BATCH_ALIGNMENT, bytes);
+}
+
+//moves the used part of an array into its grown copy and frees the old one
+static double* move_aligned(double* old, double* grown, long long used)
+{
+    if(old != NULL)
+    {
+        memcpy(grown, old, (size_t) used * sizeof(double));
+    }
+    free(old);
+    return grown;
+}
+
+TasksetBatch* new_TasksetBatch(int capacity)
+{
+    TasksetBatch* batch = (TasksetBatch*) calloc(1, sizeof(TasksetBatch));
+    batch->capacity = capacity > 0 ? capacity : 16;
+    batch->num_tasks = (int*) malloc(batch->capacity * sizeof(int));
+    batch->offset = (long long*) malloc(batch->capacity * sizeof(long long));
+    batch->liu_layland = (double*) malloc(sizeof(double));
+    batch->liu_layland[0] = 1;
+    return batch;
+}
+
+void free_TasksetBatch(TasksetBatch* batch)
+{
+    if(batch == NULL)
+    {
+        return;
+    }
+    free(batch->num_tasks);
+    free(batch->offset);
+    free(batch->execution_time);
+    free(batch->period);
+    free(batch->deadline);
+    free(batch->liu_layland);
+    free(batch);
+}
+
+//copies a taskset into the batch, returns its index or -1 when memory runs out, the batch is left as it was then
+//the Liu and Layland bound of every task count seen so far is worked out here, once, never in the kernels
+int taskset_batch_add(TasksetBatch* batch, const Task tasks[], int num_tasks)
+{
+    if(batch->num_tasksets == batch->capacity)
+    {
+        int capacity = batch->capacity * 2;
+        int* num_tasks_grown = (int*) realloc(batch->num_tasks, capacity * sizeof(int));
+        if(num_tasks_grown != NULL) batch->num_tasks = num_tasks_grown;
+        long long* offset_grown = (long long*) realloc(batch->offset, capacity * sizeof(long long));
+        if(offset_grown != NULL) batch->offset = offset_grown;
+        if(num_tasks_grown == NULL || offset_grown == NULL)
+        {
+            fprintf(stderr,"[ERROR]: out of memory growing a batch to %d tasksets\n",capacity);
+            return -1;
+        }
+        batch->capacity = capacity;
+    }
+
+    long long padded = (num_tasks + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+    if(batch->slots + padded > batch->slot_capacity)
+    {
+        long long capacity = batch->slot_capacity > 0 ? batch->slot_capacity : 1024;
+        while(capacity < batch->slots + padded) capacity *= 2;
+        //all three are allocated before any old one is let go, so a failure leaves the batch intact
+        double* execution_time = new_aligned(capacity);
+        double* period = new_aligned(capacity);
+        double* deadline = new_aligned(capacity);
+        if(execution_time == NULL || period == NULL || deadline == NULL)
+        {
+            fprintf(stderr,"[ERROR]: out of memory growing a batch to %lld tasks\n",capacity);
+            free(execution_time);
+            free(period);
+            free(deadline);
+            return -1;
+        }
+        batch->execution_time = move_aligned(batch->execution_time, execution_time, batch->slots);
+        batch->period = move_aligned(batch->period, period, batch->slots);
+        batch->deadline = move_aligned(batch->deadline, deadline, batch->slots);
+        batch->slot_capacity = capacity;
+    }
+
+    if(num_tasks > batch->max_tasks)
+    {
+        double* liu_layland = (double*) realloc(batch->liu_layland, (num_tasks + 1) * sizeof(double));
+        if(liu_layland == NULL)
+        {
+            fprintf(stderr,"[ERROR]: out of memory growing a batch to %d task bounds\n",num_tasks + 1);
+            return -1;
+        }
+        batch->liu_layland = liu_layland;
+        for(int n = batch->max_tasks + 1; n <= num_tasks; n++)
+        {
+            batch->liu_layland[n] = n * (pow(2.0, 1.0 / n) - 1);
+        }
+        batch->max_tasks = num_tasks;
+    }
+
+    long long base = batch->slots;
+    for(int i = 0; i < num_tasks; i++)
+    {
+        batch->execution_time[base + i] = (double) tasks[i].execution_time;
+        batch->period[base + i] = (double) tasks[i].period;
+        batch->deadline[base + i] = (double) tasks[i].relative_deadline;
+    }
+    //neutral padding: adds nothing to any sum and never counts as a constrained deadline
+    for(long long i = num_tasks; i < padded; i++)
+    {
+        batch->execution_time[base + i] = 0;
+        batch->period[base + i] = 1;
+        batch->deadline[base + i] = 1;
+    }
+
+    int index = batch->num_tasksets++;
+    batch->num_tasks[index] = num_tasks;
+    batch->offset[index] = base;
+    batch->slots += padded;
+    return index;
+}
+
+static inline uint8_t batch_verdict(const TasksetBatch* batch, int k, const BatchSums* sums)
+{
+    uint8_t verdict = 0;
+    if(sums->utilization <= 1) verdict |= BATCH_UTILIZATION;
+    if(sums->density <= 1) verdict |= BATCH_EDF_DENSITY;
+    if(!sums->constrained)
+    {
+        if(sums->utilization <= batch->liu_layland[batch->num_tasks[k]]) verdict |= BATCH_RM_LIU_LAYLAND;
+        if(sums->hyperbolic <= 2) verdict |= BATCH_RM_HYPERBOLIC;
+        if(sums->utilization <= 1) verdict |= BATCH_EDF_EXACT;
+    }
+    return verdict;
+}
+
+//the reference kernel, four lanes in plain c and folded in the same order as the vector kernels
+static void scalar_kernel(const TasksetBatch* batch, uint8_t verdicts[], double utilization[])
+{
+    for(int k = 0; k < batch->num_tasksets; k++)
+    {
+        const double* c = batch->execution_time + batch->offset[k];
+        const double* t = batch->period + batch->offset[k];
+        const double* d = batch->deadline + batch->offset[k];
+        long long padded = (batch->num_tasks[k] + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+        double u[BATCH_LANES] = {0, 0, 0, 0};
+        double density[BATCH_LANES] = {0, 0, 0, 0};
+        double product[BATCH_LANES] = {1, 1, 1, 1};
+        bool constrained = false;
+        for(long long i = 0; i < padded; i += BATCH_LANES)
+        {
+            for(int lane = 0; lane < BATCH_LANES; lane++)
+            {
+                double share = c[i + lane] / t[i + lane];
+                double window = d[i + lane] < t[i + lane] ? d[i + lane] : t[i + lane];
+                u[lane] += share;
+                density[lane] += c[i + lane] / window;
+                product[lane] *= share + 1;
+                constrained |= d[i + lane] < t[i + lane];
+            }
+        }
+        BatchSums sums = {
+            (u[0] + u[2]) + (u[1] + u[3]),
+            (density[0] + density[2]) + (density[1] + density[3]),
+            (product[0] * product[2]) * (product[1] * product[3]),
+            constrained
+        };
+        verdicts[k] = batch_verdict(batch, k, &sums);
+        if(utilization != NULL) utilization[k] = sums.utilization;
+    }
+}
+
+#ifdef BATCH_X86
+//two registers of two lanes, lanes {0, 1} and {2, 3}, the first fold adds them lane by lane
+static void sse2_kernel(const TasksetBatch* batch, uint8_t verdicts[], double utilization[])
+{
+    const __m128d one = _mm_set1_pd(1);
+    for(int k = 0; k < batch->num_tasksets; k++)
+    {
+        const double* c = batch->execution_time + batch->offset[k];
+        const double* t = batch->period + batch->offset[k];
+        const double* d = batch->deadline + batch->offset[k];
+        long long padded = (batch->num_tasks[k] + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+        __m128d u_low = _mm_setzero_pd(), u_high = _mm_setzero_pd();
+        __m128d density_low = _mm_setzero_pd(), density_high = _mm_setzero_pd();
+        __m128d product_low = one, product_high = one;
+        __m128d constrained = _mm_setzero_pd();
+        for(long long i = 0; i < padded; i += BATCH_LANES)
+        {
+            __m128d c_low = _mm_load_pd(c + i), c_high = _mm_load_pd(c + i + 2);
+            __m128d t_low = _mm_load_pd(t + i), t_high = _mm_load_pd(t + i + 2);
+            __m128d d_low = _mm_load_pd(d + i), d_high = _mm_load_pd(d + i + 2);
+            __m128d share_low = _mm_div_pd(c_low, t_low), share_high = _mm_div_pd(c_high, t_high);
+            u_low = _mm_add_pd(u_low, share_low);
+            u_high = _mm_add_pd(u_high, share_high);
+            density_low = _mm_add_pd(density_low, _mm_div_pd(c_low, _mm_min_pd(d_low, t_low)));
+            density_high = _mm_add_pd(density_high, _mm_div_pd(c_high, _mm_min_pd(d_high, t_high)));
+            product_low = _mm_mul_pd(product_low, _mm_add_pd(share_low, one));
+            product_high = _mm_mul_pd(product_high, _mm_add_pd(share_high, one));
+            constrained = _mm_or_pd(constrained, _mm_or_pd(_mm_cmplt_pd(d_low, t_low), _mm_cmplt_pd(d_high, t_high)));
+        }
+        __m128d u = _mm_add_pd(u_low, u_high);
+        __m128d density = _mm_add_pd(density_low, density_high);
+        __m128d product = _mm_mul_pd(product_low, product_high);
+        BatchSums sums = {
+            _mm_cvtsd_f64(_mm_add_sd(u, _mm_unpackhi_pd(u, u))),
+            _mm_cvtsd_f64(_mm_add_sd(density, _mm_unpackhi_pd(density, density))),
+            _mm_cvtsd_f64(_mm_mul_sd(product, _mm_unpackhi_pd(product, product))),
+            _mm_movemask_pd(constrained) != 0
+        };
+        verdicts[k] = batch_verdict(batch, k, &sums);
+        if(utilization != NULL) utilization[k] = sums.utilization;
+    }
+}
+
+//all four lanes in one register, compiled for avx2 on its own so the rest of the build keeps its flags
+__attribute__((target("avx2")))
+static void avx2_kernel(const TasksetBatch* batch, uint8_t verdicts[], double utilization[])
+{
+    const __m256d one = _mm256_set1_pd(1);
+    for(int k = 0; k < batch->num_tasksets; k++)
+    {
+        const double* c = batch->execution_time + batch->offset[k];
+        const double* t = batch->period + batch->offset[k];
+        const double* d = batch->deadline + batch->offset[k];
+        long long padded = (batch->num_tasks[k] + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+        __m256d u = _mm256_setzero_pd();
+        __m256d density = _mm256_setzero_pd();
+        __m256d product = one;
+        __m256d constrained = _mm256_setzero_pd();
+        for(long long i = 0; i < padded; i += BATCH_LANES)
+        {
+            __m256d c4 = _mm256_load_pd(c + i);
+            __m256d t4 = _mm256_load_pd(t + i);
+            __m256d d4 = _mm256_load_pd(d + i);
+            __m256d share = _mm256_div_pd(c4, t4);
+            u = _mm256_add_pd(u, share);
+            density = _mm256_add_pd(density, _mm256_div_pd(c4, _mm256_min_pd(d4, t4)));
+            product = _mm256_mul_pd(product, _mm256_add_pd(share, one));
+            constrained = _mm256_or_pd(constrained, _mm256_cmp_pd(d4, t4, _CMP_LT_OQ));
+        }
+        //lanes {0, 1} + {2, 3} first, then the two halves, the order the other kernels fold in
+        __m128d u2 = _mm_add_pd(_mm256_castpd256_pd128(u), _mm256_extractf128_pd(u, 1));
+        __m128d density2 = _mm_add_pd(_mm256_castpd256_pd128(density), _mm256_extractf128_pd(density, 1));
+        __m128d product2 = _mm_mul_pd(_mm256_castpd256_pd128(product), _mm256_extractf128_pd(product, 1));
+        BatchSums sums = {
+            _mm_cvtsd_f64(_mm_add_sd(u2, _mm_unpackhi_pd(u2, u2))),
+            _mm_cvtsd_f64(_mm_add_sd(density2, _mm_unpackhi_pd(density2, density2))),
+            _mm_cvtsd_f64(_mm_mul_sd(product2, _mm_unpackhi_pd(product2, product2))),
+            _mm256_movemask_pd(constrained) != 0
+        };
+        verdicts[k] = batch_verdict(batch, k, &sums);
+        if(utilization != NULL) utilization[k] = sums.utilization;
+    }
+}
+#endif
+
+//the kernel a request actually gets: AUTO and anything the cpu lacks fall back to the widest one it has
+BatchKernel batch_kernel_available(BatchKernel kernel)
+{
+#ifdef BATCH_X86
+    bool avx2 = __builtin_cpu_supports("avx2");
+    if(kernel == BATCH_KERNEL_AUTO || (kernel == BATCH_KERNEL_AVX2 && !avx2))
+    {
+        return avx2 ? BATCH_KERNEL_AVX2 : BATCH_KERNEL_SSE2;
+    }
+    return kernel;
+#else
+    (void) kernel;
+    return BATCH_KERNEL_SCALAR;
+#endif
+}
+
+const char* batch_kernel_name(BatchKernel kernel)
+{
+    switch(kernel)
+    {
+        case BATCH_KERNEL_SCALAR: return "scalar";
+        case BATCH_KERNEL_SSE2: return "SSE2";
+        case BATCH_KERNEL_AVX2: return "AVX2";
+        default: return "auto";
+    }
+}
+
+//screens every taskset of the batch, verdicts[k] gets the BatchVerdict bits of taskset k
+//utilization (may be NULL) gets each taskset's total utilization, no i/o and no allocation
+//the sums are doubles: a taskset within rounding of a bound should be confirmed with the exact tests of analysis.h
+//returns the kernel that ran
+BatchKernel analyse_taskset_batch(const TasksetBatch* batch, BatchKernel kernel, uint8_t verdicts[], double utilization[])
+{
+    kernel = batch_kernel_available(kernel);
+    switch(kernel)
+    {
+#ifdef BATCH_X86
+        case BATCH_KERNEL_AVX2:
+            avx2_kernel(batch, verdicts, utilization);
+            break;
+        case BATCH_KERNEL_SSE2:
+            sse2_kernel(batch, verdicts, utilization);
+            break;
+#endif
+        default:
+            scalar_kernel(batch, verdicts, utilization);
+            break;
+    }
+    return kernel;
+}
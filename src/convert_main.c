@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "../include/task.h"
+#include "../include/taskset_io.h"
+
+static void usage(const char* program)
+{
+    printf("usage %s [-b | -t] <input> <output>\n",program);
+    printf("      -b writes the binary format, -t the text format, without either the input's format is flipped\n");
+}
+
+//convert a taskset between the text and the binary format
+int main(int argc, char* argv[])
+{
+    int target = 0;
+    int option;
+    while((option = getopt(argc, argv, "bt")) != -1)
+    {
+        switch(option)
+        {
+            case 'b': target = 'b'; break;
+            case 't': target = 't'; break;
+            default:
+                usage(argv[0]);
+                return -1;
+        }
+    }
+    if(argc - optind != 2)
+    {
+        usage(argv[0]);
+        return -1;
+    }
+
+    const char* input = argv[optind];
+    const char* output = argv[optind + 1];
+
+    //sniff the input so the default direction is the other format
+    FILE* probe = fopen(input, "rb");
+    if(probe == NULL)
+    {
+        fprintf(stderr,"[ERROR]: Error opening %s\n",input);
+        return -2;
+    }
+    char magic[sizeof(TASKSET_MAGIC)];
+    bool binary_input = fread(magic, 1, sizeof(magic), probe) == sizeof(magic) && memcmp(magic, TASKSET_MAGIC, sizeof(magic)) == 0;
+    fclose(probe);
+    if(target == 0)
+    {
+        target = binary_input ? 't' : 'b';
+    }
+
+    int num_tasks = 0;
+    Task* tasks = binary_input ? load_taskset_binary(input, &num_tasks) : load_taskset_text(input, &num_tasks);
+    if(tasks == NULL)
+    {
+        return -2;
+    }
+
+    FILE* file = fopen(output, target == 'b' ? "wb" : "w");
+    if(file == NULL)
+    {
+        fprintf(stderr,"[ERROR]: Error opening %s\n",output);
+        free(tasks);
+        return -2;
+    }
+    bool written = target == 'b' ? write_taskset_binary(file, tasks, num_tasks) : write_taskset(file, tasks, num_tasks);
+    written = fclose(file) == 0 && written;
+    free(tasks);
+    if(!written)
+    {
+        fprintf(stderr,"[ERROR]: Error writing %s\n",output);
+        return -2;
+    }
+    return 0;
+}
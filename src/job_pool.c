@@ -0,0 +1,116 @@
+#include "../include/job_pool.h"
+#include <stdlib.h>
+
+//every object is at least pointer sized so a free object can hold the free list link
+static void object_pool_init(ObjectPool* pool, size_t object_size)
+{
+    if(object_size < sizeof(void*))
+    {
+        object_size = sizeof(void*);
+    }
+    //keep every object in a slab pointer aligned
+    object_size = (object_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    pool->object_size = object_size;
+    pool->free_list = NULL;
+    pool->slabs = NULL;
+    pool->live = 0;
+    pool->peak_live = 0;
+    pool->capacity = 0;
+}
+
+//a new slab is only carved when the free list is empty,
+//so capacity never exceeds the peak number of live objects by more than one slab
+static void object_pool_grow(ObjectPool* pool)
+{
+    size_t header = (sizeof(Slab) + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    Slab* slab = (Slab*) malloc(header + POOL_SLAB_OBJECTS * pool->object_size);
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+
+    char* objects = (char*) slab + header;
+    for(int i = POOL_SLAB_OBJECTS - 1; i >= 0; i--)
+    {
+        void* object = objects + i * pool->object_size;
+        *(void**) object = pool->free_list;
+        pool->free_list = object;
+    }
+    pool->capacity += POOL_SLAB_OBJECTS;
+}
+
+static void* object_pool_alloc(ObjectPool* pool)
+{
+    if(pool->free_list == NULL)
+    {
+        object_pool_grow(pool);
+    }
+
+    void* object = pool->free_list;
+    pool->free_list = *(void**) object;
+
+    pool->live++;
+    if(pool->live > pool->peak_live)
+    {
+        pool->peak_live = pool->live;
+    }
+    return object;
+}
+
+static void object_pool_free(ObjectPool* pool, void* object)
+{
+    *(void**) object = pool->free_list;
+    pool->free_list = object;
+    pool->live--;
+}
+
+static void object_pool_release(ObjectPool* pool)
+{
+    Slab* slab = pool->slabs;
+    while(slab != NULL)
+    {
+        Slab* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->live = 0;
+    pool->capacity = 0;
+}
+
+JobPool* new_JobPool(void)
+{
+    JobPool* pool = (JobPool*) malloc(sizeof(JobPool));
+    object_pool_init(&pool->jobs, sizeof(Job));
+    object_pool_init(&pool->nodes, sizeof(Node));
+    return pool;
+}
+
+//release every slab in one go, jobs and nodes still in use become invalid
+void free_JobPool(JobPool* pool)
+{
+    if(pool == NULL) return;
+    object_pool_release(&pool->jobs);
+    object_pool_release(&pool->nodes);
+    free(pool);
+}
+
+Job* job_pool_alloc_job(JobPool* pool)
+{
+    return (Job*) object_pool_alloc(&pool->jobs);
+}
+
+void job_pool_free_job(JobPool* pool, Job* job)
+{
+    object_pool_free(&pool->jobs, job);
+}
+
+Node* job_pool_alloc_node(JobPool* pool)
+{
+    return (Node*) object_pool_alloc(&pool->nodes);
+}
+
+void job_pool_free_node(JobPool* pool, Node* node)
+{
+    object_pool_free(&pool->nodes, node);
+}
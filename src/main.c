@@ -1,88 +1,791 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include "../include/task.h"
 #include "../include/utils.h"
+#include "../include/taskset_io.h"
 #include "../include/sched_new.h"
+#include "../include/timeline.h"
+#include "../include/batch.h"
+#include "../include/thread_pool.h"
+#include "../include/partition.h"
+#include "../include/trace.h"
+#include "../include/analysis.h"
+#include "../include/monte_carlo.h"
 
-int main(int argc, char* argv[]) 
+#define TIMELINE_BUFFER 1024
+
+//longest stretch simulated when the hyperperiod is larger or does not fit in 64 bits
+#define DEFAULT_HORIZON_CAP 10000000LL
+
+//bytes of an arrival trace read ahead of the replay
+#define ARRIVAL_READ_AHEAD (1 << 20)
+
+//records the simulating thread can get ahead of the exporter by before dropping
+#define TRACE_BUFFER (1 << 20)
+
+//with -T every run is traced to its own <prefix>-<run>.json
+static const char* trace_prefix = NULL;
+
+//with -r every run replays this recorded arrival trace instead of the periodic releases
+static ArrivalStream* arrivals = NULL;
+
+//with -f every run stops at its first deadline miss, and the uniprocessor ones only simulate their feasibility interval
+static bool feasibility = false;
+
+//the uniprocessor fixed priority run, -o picks how its priorities are assigned
+typedef struct fixed_priority_run
 {
-    if(argc < 2)
+    const char* name;
+    char test;
+    scheduler_fn scheduler;
+    replay_fn replay;
+    sampled_fn sampled;
+} FixedPriorityRun;
+
+//opa goes through the taskset's explicit priorities, assign_priorities gives it Audsley's order first
+static bool fixed_priority_run(const char* assignment, FixedPriorityRun* run)
+{
+    static const FixedPriorityRun runs[] = {
+        { "RM", 'R', rate_monotonic_scheduler, rate_monotonic_replay, rate_monotonic_sampled },
+        { "DM", 'M', deadline_monotonic_scheduler, deadline_monotonic_replay, deadline_monotonic_sampled },
+        { "OPA", 'A', fixed_priority_scheduler, fixed_priority_replay, fixed_priority_sampled },
+    };
+    const char* names[] = { "rm", "dm", "opa" };
+    for(int i = 0; i < 3; i++)
     {
-        printf("usage %s <filename.txt>\n",argv[0]);
-        return -1;
+        if(strcmp(assignment, names[i]) == 0)
+        {
+            *run = runs[i];
+            return true;
+        }
     }
+    return false;
+}
 
-    FILE* task_file = fopen(argv[1],"r");
-    int num_tasks = 0;
+static bool trace_begin(const char* run, TraceExporter* exporter)
+{
+    static TraceBuffer* buffer = NULL;
+    if(trace_prefix == NULL)
+    {
+        return false;
+    }
+    if(buffer == NULL)
+    {
+        buffer = new_TraceBuffer(TRACE_BUFFER);
+    }
 
-    if(task_file == NULL)
+    char path[4096];
+    snprintf(path, sizeof(path), "%s-%s.json", trace_prefix, run);
+    FILE* out = fopen(path, "w");
+    if(out == NULL)
     {
-        printf("[ERROR]: Error opening %s\n",argv[1]);
-        return -2;
+        fprintf(stderr,"[ERROR]: Error opening %s\n",path);
+        return false;
+    }
+    if(!trace_export_start(exporter, buffer, out))
+    {
+        fclose(out);
+        return false;
+    }
+    trace_current = buffer;
+    return true;
+}
+
+static void trace_end(const char* run, TraceExporter* exporter, sched_time_t end)
+{
+    trace_current = NULL;
+    long long exported = trace_export_stop(exporter, end);
+    fclose(exporter->out);
+    fprintf(stderr,"[TRACE]: %s-%s.json: %lld events, %lld dropped\n",trace_prefix,run,exported,exporter->buffer->dropped);
+}
+
+//where a run ended, earlier than the horizon when it stopped at its first deadline miss
+static sched_time_t run_end(const Metrics* metrics, sched_time_t horizon)
+{
+    if(metrics != NULL && metrics->stop_at_miss && metrics->first_miss.task >= 0)
+    {
+        return metrics->first_miss.completion;
+    }
+    return horizon;
+}
+
+static void print_verdict(const Metrics* metrics, sched_time_t horizon)
+{
+    const JobRecord* miss = &metrics->first_miss;
+    if(miss->task >= 0)
+    {
+        printf("first deadline miss: T%d job %lld due at %lld completed at %lld, stopped there\n",miss->task_id,miss->instance,miss->deadline,miss->completion);
+    }
+    else if(metrics_total_missed(metrics) > 0)
+    {
+        printf("deadline missed by a job still pending at %lld\n",horizon);
+    }
+    else
+    {
+        printf("no deadline miss in [0, %lld)\n",horizon);
+    }
+}
+
+//with -f: how long a policy's run is, its feasibility interval when one is known, bounded by the cap
+//simulated (the usual horizon) otherwise
+static sched_time_t feasibility_horizon(const char* run, sched_time_t interval, const char* basis, sched_time_t hyperperiod, sched_time_t simulated, sched_time_t cap)
+{
+    if(interval < 0)
+    {
+        printf("[WARNING]: no %s feasibility interval (%s), simulating %lld time units\n",run,basis,simulated);
+        return simulated;
+    }
+    if(hyperperiod >= 0)
+    {
+        printf("%s feasibility interval: %lld (%s), hyperperiod %lld\n",run,interval,basis,hyperperiod);
+    }
+    else
+    {
+        printf("%s feasibility interval: %lld (%s), hyperperiod does not fit in 64 bits\n",run,interval,basis);
+    }
+    if(interval > cap)
+    {
+        printf("[WARNING]: %s feasibility interval is above the cap, simulating the first %lld time units\n",run,cap);
+        return cap;
+    }
+    return interval;
+}
+
+//run one scheduler over the horizon, segments are printed as they are produced
+//so memory stays at the stream buffer no matter how long the horizon is
+//with stats the per task metrics are printed after the schedule
+static void simulate(scheduler_fn scheduler, replay_fn replay, const char* run, const Taskset* taskset, sched_time_t horizon, bool quiet, bool stats)
+{
+    Metrics metrics;
+    bool with_metrics = stats || feasibility;
+    if(with_metrics)
+    {
+        metrics_init(&metrics, taskset->num_tasks);
+        metrics.stop_at_miss = feasibility;
+    }
+    TraceExporter exporter;
+    bool traced = trace_begin(run, &exporter);
+
+    Timeline timeline;
+    if(!quiet)
+    {
+        timeline_init_stream(&timeline, TIMELINE_BUFFER, plot_segment, NULL);
+    }
+    if(arrivals != NULL)
+    {
+        rewind_arrival_stream(arrivals);
+        replay(taskset,arrivals,horizon,quiet ? NULL : &timeline,with_metrics ? &metrics : NULL);
+    }
+    else
+    {
+        scheduler(taskset,horizon,quiet ? NULL : &timeline,with_metrics ? &metrics : NULL);
+    }
+    if(!quiet)
+    {
+        timeline_flush(&timeline);
+        printf("\n");
+        timeline_free(&timeline);
+    }
+    if(traced)
+    {
+        trace_end(run, &exporter, run_end(with_metrics ? &metrics : NULL, horizon));
+    }
+    if(arrivals != NULL)
+    {
+        printf("%lld jobs replayed from %s%s\n",arrivals->replayed,arrivals->path,arrivals->failed ? " before an error" : "");
     }
 
-    
-    fscanf(task_file,"%d",&num_tasks); 
+    if(feasibility)
+    {
+        print_verdict(&metrics, horizon);
+    }
+    if(stats)
+    {
+        print_metrics(&metrics, stdout);
+    }
+    if(with_metrics)
+    {
+        metrics_free(&metrics);
+    }
+}
+
+//run one global scheduler on num_cores cores, then print every core's schedule and counters
+//per core timelines are buffered, a streaming one would interleave the cores' output
+static void simulate_global(global_scheduler_fn scheduler, global_replay_fn replay, const char* run, const Taskset* taskset, int num_cores, sched_time_t horizon, bool quiet, bool with_metrics)
+{
+    Metrics metrics;
+    bool stats_wanted = with_metrics;
+    with_metrics = with_metrics || feasibility;
+    if(with_metrics)
+    {
+        metrics_init(&metrics, taskset->num_tasks);
+        metrics.stop_at_miss = feasibility;
+    }
+
+    CoreStats* stats = (CoreStats*) malloc(num_cores * sizeof(CoreStats));
+    Timeline* timelines = NULL;
+    if(!quiet)
+    {
+        timelines = (Timeline*) malloc(num_cores * sizeof(Timeline));
+        for(int c = 0; c < num_cores; c++)
+        {
+            timeline_init(&timelines[c]);
+        }
+    }
 
-    Task tasks[num_tasks];
-    
+    TraceExporter exporter;
+    bool traced = trace_begin(run, &exporter);
+    if(arrivals != NULL)
+    {
+        rewind_arrival_stream(arrivals);
+        replay(taskset,num_cores,arrivals,horizon,timelines,stats,with_metrics ? &metrics : NULL);
+    }
+    else
+    {
+        scheduler(taskset,num_cores,horizon,timelines,stats,with_metrics ? &metrics : NULL);
+    }
+    if(traced)
+    {
+        trace_end(run, &exporter, run_end(with_metrics ? &metrics : NULL, horizon));
+    }
+
+    for(int c = 0; c < num_cores && !quiet; c++)
+    {
+        printf("Core %d:\t",c);
+        plot_timeline(&timelines[c]);
+        timeline_free(&timelines[c]);
+    }
+    printf("core\tpreemptions\tmigrations\tbusy\n");
+    for(int c = 0; c < num_cores; c++)
+    {
+        printf("%d\t%lld\t\t%lld\t\t%lld\n",c,stats[c].preemptions,stats[c].migrations,stats[c].busy_time);
+    }
+    if(arrivals != NULL)
+    {
+        printf("%lld jobs replayed from %s%s\n",arrivals->replayed,arrivals->path,arrivals->failed ? " before an error" : "");
+    }
+    if(feasibility)
+    {
+        print_verdict(&metrics, horizon);
+    }
+    if(stats_wanted)
+    {
+        print_metrics(&metrics, stdout);
+    }
+    if(with_metrics)
+    {
+        metrics_free(&metrics);
+    }
+    free(timelines);
+    free(stats);
+}
+
+//replications of one policy with drawn execution times, only the statistics are printed
+static void simulate_monte_carlo(sampled_fn scheduler, const char* name, const Taskset* taskset, const MonteCarloParams* params)
+{
+    char model[128];
+    describe_execution_model(&params->model, model, sizeof(model));
+    printf("Monte Carlo %s: %d replications of %lld time units, execution times %s\n",name,params->replications,params->horizon,model);
+
+    MonteCarloResult result;
+    monte_carlo(taskset, scheduler, params, &result);
+    print_monte_carlo(&result, stdout);
+    free_MonteCarloResult(&result);
+}
+
+//pack the taskset onto cores under the given admission test, then simulate every core in parallel
+static void simulate_partition(PartitionHeuristic heuristic, PartitionTest test, scheduler_fn schedulers[], const char* names[], int num_schedulers,
+                               Task tasks[], int num_tasks, int max_cores, int num_threads, sched_time_t horizon, bool quiet)
+{
+    Partition partition;
+    partition_tasks(tasks, num_tasks, heuristic, test, max_cores, &partition);
+
+    printf("%s admission: %d cores\n", test == PARTITION_TEST_RM ? "RM" : "EDF", partition.num_cores);
+    printf("core\ttasks\tutilization\n");
+    for(int c = 0; c < partition.num_cores; c++)
+    {
+        printf("%d\t",c);
+        for(int i = 0; i < num_tasks; i++)
+        {
+            if(partition.core_of[i] == c) printf("T%d ",i);
+        }
+        printf("\t%f\n",partition.core_utilization[c]);
+    }
+    if(partition.unassigned > 0)
+    {
+        printf("[WARNING]: %d tasks fit on no core:",partition.unassigned);
+        for(int i = 0; i < num_tasks; i++)
+        {
+            if(partition.core_of[i] < 0) printf(" T%d",i);
+        }
+        printf("\n");
+    }
+
+    Timeline* timelines = quiet ? NULL : (Timeline*) malloc((partition.num_cores > 0 ? partition.num_cores : 1) * sizeof(Timeline));
+    for(int s = 0; s < num_schedulers; s++)
+    {
+        for(int c = 0; c < partition.num_cores && !quiet; c++)
+        {
+            timeline_init(&timelines[c]);
+        }
+
+        PartitionTiming timing = { 0, 0, NULL };
+        simulate_partitioned(tasks, num_tasks, &partition, schedulers[s], horizon, num_threads, timelines, &timing);
+
+        printf("Schedule for partitioned %s:\n",names[s]);
+        for(int c = 0; c < partition.num_cores && !quiet; c++)
+        {
+            printf("Core %d:\t",c);
+            plot_timeline(&timelines[c]);
+            timeline_free(&timelines[c]);
+        }
+        printf("%d cores on %d threads: wall %.1f us, serial %.1f us, speedup %.2fx\n",partition.num_cores,num_threads,
+            timing.wall_us,timing.serial_us,timing.wall_us > 0 ? timing.serial_us / timing.wall_us : 0.0);
+    }
+    free(timelines);
+    free_Partition(&partition);
+}
+
+static void usage(const char* program)
+{
+    printf("usage %s [-t horizon] [-c hyperperiod cap] [-m cores] [-P ff|bf|wf] [-o rm|dm|opa] [-O preemption[:migration]] [-q] [-s] [-f] [-r arrival trace] [-T trace prefix] <filename.txt>\n",program);
+    printf("      %s -L [-o rm|dm|opa] [-O preemption] [-t horizon] [-c hyperperiod cap] <filename.txt>\n",program);
+    printf("      %s -M replications [-E execution time model] [-S seed] [-o rm|dm|opa] [-j threads] [-t horizon] [-c hyperperiod cap] <filename.txt>\n",program);
+    printf("      %s -b <directory|manifest> [-j threads] [-t horizon] [-c hyperperiod cap]\n",program);
+}
+
+//-O preemption[:migration], the migration cost is 0 when left out
+static bool parse_switch_costs(const char* text, sched_time_t* preemption_cost, sched_time_t* migration_cost)
+{
+    char* end;
+    *preemption_cost = strtoll(text, &end, 10);
+    *migration_cost = 0;
+    if(end != text && *end == ':')
+    {
+        const char* migration = end + 1;
+        *migration_cost = strtoll(migration, &end, 10);
+        if(end == migration) return false;
+    }
+    return end != text && *end == '\0' && *preemption_cost >= 0 && *migration_cost >= 0;
+}
+
+//with -O: the fixed priority run (order) or EDF analysed with every preemption charged its cost
+static void print_overhead_analysis(Task tasks[], int num_tasks, FeasibilityPolicy policy, const int order[], const char* name, sched_time_t preemption_cost)
+{
+    PreemptionModel model = { preemption_cost, NULL, NULL };
+    if(policy == FEASIBILITY_FIXED_PRIORITY)
+    {
+        sched_time_t* wcrt = (sched_time_t*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(sched_time_t));
+        bool schedulable = limited_preemption_analysis(tasks, num_tasks, order, &model, wcrt);
+        printf("response time analysis with a preemption cost of %lld: %sschedulable under %s\n",preemption_cost,schedulable ? "" : "not ",name);
+        free(wcrt);
+        return;
+    }
+
+    sched_time_t failing_interval = 0;
+    if(edf_limited_analysis(tasks, num_tasks, &model, &failing_interval))
+    {
+        printf("processor demand analysis with a preemption cost of %lld: schedulable under %s\n",preemption_cost,name);
+    }
+    else
+    {
+        printf("processor demand analysis with a preemption cost of %lld: demand exceeds [0,%lld], not schedulable under %s\n",preemption_cost,failing_interval,name);
+    }
+}
+
+//with -L: the fixed priority order and EDF fully preemptive, with preemption thresholds (fixed priority only) and
+//with floating non-preemptive regions, each parameter set as large as the analysis allows, then every variant is
+//analysed and simulated quietly over the horizon with the taskset's costs
+//the variants are shallow copies of the taskset pointing at their own priority, threshold and region arrays
+static void compare_limited_preemption(Task tasks[], int num_tasks, const Taskset* taskset, const int order[], const char* name, sched_time_t horizon)
+{
+    enum { VARIANTS = 5 };
+    size_t size = (num_tasks > 0 ? num_tasks : 1) * sizeof(sched_time_t);
+    sched_time_t* level = (sched_time_t*) malloc(size);
+    sched_time_t* threshold = (sched_time_t*) malloc(size);
+    sched_time_t* fixed_region = (sched_time_t*) malloc(size);
+    sched_time_t* edf_region = (sched_time_t*) malloc(size);
+    sched_time_t* wcrt = (sched_time_t*) malloc(3 * size);
+    int* threshold_level = (int*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(int));
+    sched_time_t cost = taskset->preemption_cost;
+
+    for(int l = 0; l < num_tasks; l++)
+    {
+        level[order[l]] = l;
+    }
+    bool schedulable[VARIANTS];
+    PreemptionModel preemptive = { cost, NULL, NULL };
+    schedulable[0] = limited_preemption_analysis(tasks, num_tasks, order, &preemptive, wcrt);
+    schedulable[1] = assign_preemption_thresholds(tasks, num_tasks, order, cost, threshold_level);
+    schedulable[2] = fixed_priority_region_lengths(tasks, num_tasks, order, cost, fixed_region);
+    schedulable[3] = edf_limited_analysis(tasks, num_tasks, &preemptive, NULL);
+    schedulable[4] = edf_region_lengths(tasks, num_tasks, cost, edf_region);
     for(int i = 0; i < num_tasks; i++)
     {
+        threshold[i] = threshold_level[i];
+    }
+
+    //analysed worst case responses of the three fixed priority variants, wcrt[v * num_tasks + i]
+    PreemptionModel thresholds = { cost, threshold_level, NULL };
+    PreemptionModel regions = { cost, NULL, fixed_region };
+    limited_preemption_analysis(tasks, num_tasks, order, &thresholds, wcrt + num_tasks);
+    limited_preemption_analysis(tasks, num_tasks, order, &regions, wcrt + 2 * num_tasks);
 
-        int arrival_time,period,execution_time,deadline;
+    char names[VARIANTS][32];
+    snprintf(names[0], sizeof(names[0]), "%s", name);
+    snprintf(names[1], sizeof(names[1]), "%s-PT", name);
+    snprintf(names[2], sizeof(names[2]), "%s-NPR", name);
+    snprintf(names[3], sizeof(names[3]), "EDF");
+    snprintf(names[4], sizeof(names[4]), "EDF-NPR");
 
-        fscanf(task_file,"%d\t%d\t%d\t%d\n",&arrival_time,&period,&execution_time,&deadline);
-        tasks[i].arrival_time = arrival_time;
-        tasks[i].period = period;
-        tasks[i].execution_time = execution_time;
-        tasks[i].relative_deadline = deadline;
-        tasks[i].task_id = i;
-        tasks[i].next_arrival_time = tasks[i].arrival_time;
-        tasks[i].instance_counter = -1;
-                
+    Taskset variants[VARIANTS];
+    for(int v = 0; v < VARIANTS; v++)
+    {
+        variants[v] = *taskset;
+        variants[v].priority = v < 3 ? level : taskset->priority;
     }
+    variants[1].preemption_threshold = threshold;
+    variants[2].non_preemptive_region = fixed_region;
+    variants[4].non_preemptive_region = edf_region;
 
-    print_taskset(tasks,num_tasks);
-    printf("================================================================\n");
-    schedulability(tasks,num_tasks,'F');
+    printf("limited preemption, preemption cost %lld, %lld time units simulated\n",cost,horizon);
+    printf("T#\tlevel\tPT\t%s-NPR\tEDF-NPR\tD\tR\tR-PT\tR-NPR\n",name);
+    for(int i = 0; i < num_tasks; i++)
     {
-        int hyperperiod = calculate_hyperperiod(tasks, num_tasks);
-        int timeline[hyperperiod][2];
-        rate_monotonic_scheduler(tasks,num_tasks,timeline);
-        plot_timeline(timeline,hyperperiod);
+        printf("T%d\t%lld\t%d\t%lld\t%lld\t%lld",i,level[i],threshold_level[i],fixed_region[i],edf_region[i],tasks[i].relative_deadline);
+        for(int v = 0; v < 3; v++)
+        {
+            sched_time_t response = wcrt[v * num_tasks + i];
+            if(response <= tasks[i].relative_deadline) printf("\t%lld",response);
+            else printf("\t>%lld",tasks[i].relative_deadline);
+        }
+        printf("\n");
+    }
+
+    Metrics metrics[VARIANTS];
+    printf("run\tanalysis\tswitches\tpreempt\tmissed\toverhead\n");
+    for(int v = 0; v < VARIANTS; v++)
+    {
+        metrics_init(&metrics[v], num_tasks);
+        scheduler_fn scheduler = v < 3 ? fixed_priority_scheduler : earliest_deadline_first_scheduler;
+        scheduler(&variants[v], horizon, NULL, &metrics[v]);
+        printf("%s\t%s\t%lld\t%lld\t%lld\t%lld\n",names[v],schedulable[v] ? "yes" : "no",metrics[v].context_switches,
+            metrics_total_preemptions(&metrics[v]),metrics_total_missed(&metrics[v]),metrics[v].overhead);
     }
-    printf("================================================================\n");
 
-    
+    //worst and average response time of every task under every variant
+    printf("T#");
+    for(int v = 0; v < VARIANTS; v++)
+    {
+        printf("\t%s", names[v]);
+    }
+    printf("\n");
     for(int i = 0; i < num_tasks; i++)
     {
-        tasks[i].next_arrival_time = tasks[i].arrival_time;
-        tasks[i].instance_counter = -1;
+        printf("T%d",i);
+        for(int v = 0; v < VARIANTS; v++)
+        {
+            const TaskMetrics* task = &metrics[v].tasks[i];
+            if(task->completed == 0) printf("\t-");
+            else printf("\t%lld/%.1f",task->max_response,task->total_response / task->completed);
+        }
+        printf("\n");
+    }
+
+    for(int v = 0; v < VARIANTS; v++)
+    {
+        metrics_free(&metrics[v]);
+    }
+    free(threshold_level);
+    free(wcrt);
+    free(edf_region);
+    free(fixed_region);
+    free(threshold);
+    free(level);
+}
+
+int main(int argc, char* argv[]) 
+{
+    sched_time_t horizon = 0;
+    sched_time_t cap = DEFAULT_HORIZON_CAP;
+    bool quiet = false;
+    const char* batch_source = NULL;
+    int num_threads = default_thread_count();
+    int num_cores = 1;
+    const char* packing = NULL;
+    bool stats = false;
+    const char* arrival_trace = NULL;
+    FixedPriorityRun fixed_run;
+    fixed_priority_run("rm", &fixed_run);
+    sched_time_t preemption_cost = 0;
+    sched_time_t migration_cost = 0;
+    bool limited = false;
+    MonteCarloParams monte_carlo_params = { { EXECUTION_UNIFORM, 0.5, 0.8, 0.1, 0.05 }, 0, 1, 0, 0 };
+    int option;
+
+    while((option = getopt(argc, argv, "t:c:qb:j:m:P:sT:r:fM:E:S:o:O:L")) != -1)
+    {
+        switch(option)
+        {
+            case 't': horizon = atoll(optarg); break;
+            case 'c': cap = atoll(optarg); break;
+            case 'q': quiet = true; break;
+            case 'b': batch_source = optarg; break;
+            case 'j': num_threads = atoi(optarg); break;
+            case 'm': num_cores = atoi(optarg); break;
+            case 'P': packing = optarg; break;
+            case 's': stats = true; break;
+            case 'T': trace_prefix = optarg; break;
+            case 'r': arrival_trace = optarg; break;
+            case 'f': feasibility = true; break;
+            case 'M': monte_carlo_params.replications = atoi(optarg); break;
+            case 'E':
+                if(!parse_execution_model(optarg, &monte_carlo_params.model))
+                {
+                    printf("[ERROR]: unknown execution time model %s, expected wcet, uniform[:low], normal[:mean[:sd]] or bimodal[:p[:low]]\n",optarg);
+                    return -1;
+                }
+                break;
+            case 'S': monte_carlo_params.seed = strtoull(optarg, NULL, 10); break;
+            case 'o':
+                if(!fixed_priority_run(optarg, &fixed_run))
+                {
+                    printf("[ERROR]: unknown priority assignment %s, expected rm, dm or opa\n",optarg);
+                    return -1;
+                }
+                break;
+            case 'O':
+                if(!parse_switch_costs(optarg, &preemption_cost, &migration_cost))
+                {
+                    printf("[ERROR]: bad switch costs %s, expected preemption[:migration] as non-negative times\n",optarg);
+                    return -1;
+                }
+                break;
+            case 'L': limited = true; break;
+            default:
+                usage(argv[0]);
+                return -1;
+        }
+    }
+
+    //batch mode: every taskset under every policy on a thread pool, one summary line per run
+    if(batch_source != NULL)
+    {
+        return run_batch(batch_source, num_threads, horizon, cap, stdout) < 0 ? -2 : 0;
     }
 
-    schedulability(tasks,num_tasks,'D');
+    if(optind >= argc)
     {
-        int hyperperiod = calculate_hyperperiod(tasks, num_tasks);
-        int timeline[hyperperiod][2];
-        earliest_deadline_first_scheduler(tasks,num_tasks,timeline);
-        plot_timeline(timeline,hyperperiod);
+        usage(argv[0]);
+        return -1;
     }
 
+    if(trace_prefix != NULL && !TRACE_ENABLED)
+    {
+        printf("[WARNING]: built without SCHED_TRACE, rebuild with make clean && make TRACE=1 to trace\n");
+        trace_prefix = NULL;
+    }
+    else if(trace_prefix != NULL && packing != NULL)
+    {
+        printf("[WARNING]: partitioned runs are not traced\n");
+    }
+    if(feasibility && packing != NULL)
+    {
+        printf("[WARNING]: partitioned runs always simulate the whole horizon\n");
+    }
+    if((preemption_cost > 0 || migration_cost > 0) && packing != NULL)
+    {
+        printf("[WARNING]: partitioned runs do not charge switch costs, -O is ignored\n");
+    }
+    if(fixed_run.test != 'R' && (packing != NULL || num_cores > 1) && monte_carlo_params.replications <= 0)
+    {
+        printf("[WARNING]: partitioned and global runs keep rate monotonic priorities, -o is ignored\n");
+    }
+
+    int num_tasks = 0;
+    Task* tasks = load_taskset(argv[optind], &num_tasks);
+    if(tasks == NULL)
+    {
+        return -2;
+    }
+
+    sched_time_t hyperperiod = calculate_hyperperiod(tasks, num_tasks);
+    sched_time_t simulated = simulation_horizon(tasks, num_tasks, horizon, cap);
+    if(horizon <= 0 && hyperperiod < 0)
+    {
+        printf("[WARNING]: hyperperiod does not fit in 64 bits, simulating the first %lld time units\n",simulated);
+    }
+    else if(horizon <= 0 && simulated < hyperperiod)
+    {
+        printf("[WARNING]: hyperperiod %lld is above the cap, simulating the first %lld time units\n",hyperperiod,simulated);
+    }
+
+    //replay mode: jobs are released as recorded in the trace, the horizon is still -t or the capped hyperperiod
+    if(arrival_trace != NULL)
+    {
+        if(packing != NULL)
+        {
+            printf("[WARNING]: partitioned runs do not replay arrival traces\n");
+        }
+        arrivals = open_arrival_stream(arrival_trace, num_tasks, ARRIVAL_READ_AHEAD);
+        if(arrivals == NULL)
+        {
+            free(tasks);
+            return -2;
+        }
+    }
+
+    print_taskset(tasks,num_tasks);
+    Taskset* taskset = new_Taskset(tasks,num_tasks);
+    taskset->preemption_cost = preemption_cost;
+    taskset->migration_cost = migration_cost;
     printf("================================================================\n");
 
-    for(int i = 0; i < num_tasks; i++)
+    //the fixed priority order every uniprocessor run below uses, explicit only for opa,
+    //a taskset no fixed priority order schedules runs with deadline monotonic priorities instead
+    int* order = (int*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(int));
+    if(fixed_run.test == 'A' && optimal_priority_order(tasks,num_tasks,order,NULL))
     {
-        tasks[i].next_arrival_time = tasks[i].arrival_time;
-        tasks[i].instance_counter = -1;
+        assign_priorities(taskset,order);
     }
-    printf("Schedule for LLF:\n");
+    else
+    {
+        if(fixed_run.test == 'A')
+        {
+            printf("[WARNING]: not schedulable under any fixed priority order, -o opa falls back to DM\n");
+            fixed_priority_run("dm", &fixed_run);
+        }
+        priority_order(tasks,num_tasks,fixed_run.test == 'M' ? PRIORITY_DEADLINE_MONOTONIC : PRIORITY_RATE_MONOTONIC,order);
+    }
+
+    //limited preemption mode: fully preemptive, preemption threshold and non-preemptive region runs side by side
+    if(limited)
+    {
+        if(num_cores > 1 || packing != NULL || arrivals != NULL || monte_carlo_params.replications > 0)
+        {
+            printf("[WARNING]: limited preemption runs are uniprocessor with periodic releases, -m, -P, -r and -M are ignored\n");
+        }
+        compare_limited_preemption(tasks,num_tasks,taskset,order,fixed_run.name,simulated);
+
+        close_arrival_stream(arrivals);
+        free_Taskset(taskset);
+        free(order);
+        free(tasks);
+        return 0;
+    }
+
+    //Monte Carlo mode: every uniprocessor policy replicated with drawn execution times on -j threads
+    if(monte_carlo_params.replications > 0)
+    {
+        if(num_cores > 1 || packing != NULL || arrivals != NULL)
+        {
+            printf("[WARNING]: Monte Carlo runs are uniprocessor with periodic releases, -m, -P and -r are ignored\n");
+        }
+        monte_carlo_params.horizon = simulated;
+        monte_carlo_params.num_threads = num_threads;
+        simulate_monte_carlo(fixed_run.sampled,fixed_run.name,taskset,&monte_carlo_params);
+        printf("================================================================\n");
+        simulate_monte_carlo(earliest_deadline_first_sampled,"EDF",taskset,&monte_carlo_params);
+        printf("================================================================\n");
+        simulate_monte_carlo(least_laxity_first_sampled,"LLF",taskset,&monte_carlo_params);
+
+        close_arrival_stream(arrivals);
+        free_Taskset(taskset);
+        free(order);
+        free(tasks);
+        return 0;
+    }
+
+    //partitioned mode: first / best / worst fit decreasing onto at most -m cores (as many as needed without -m)
+    if(packing != NULL)
+    {
+        PartitionHeuristic heuristic;
+        if(strcmp(packing, "ff") == 0) heuristic = PARTITION_FIRST_FIT;
+        else if(strcmp(packing, "bf") == 0) heuristic = PARTITION_BEST_FIT;
+        else if(strcmp(packing, "wf") == 0) heuristic = PARTITION_WORST_FIT;
+        else
+        {
+            printf("[ERROR]: unknown packing %s, expected ff, bf or wf\n",packing);
+            close_arrival_stream(arrivals);
+            free_Taskset(taskset);
+            free(order);
+            free(tasks);
+            return -1;
+        }
+
+        scheduler_fn fixed[] = { rate_monotonic_scheduler };
+        const char* fixed_names[] = { "RM" };
+        scheduler_fn dynamic[] = { earliest_deadline_first_scheduler, least_laxity_first };
+        const char* dynamic_names[] = { "EDF", "LLF" };
+        int max_cores = num_cores > 1 ? num_cores : 0;
+
+        simulate_partition(heuristic,PARTITION_TEST_RM,fixed,fixed_names,1,tasks,num_tasks,max_cores,num_threads,simulated,quiet);
+        printf("================================================================\n");
+        simulate_partition(heuristic,PARTITION_TEST_EDF,dynamic,dynamic_names,2,tasks,num_tasks,max_cores,num_threads,simulated,quiet);
+
+        close_arrival_stream(arrivals);
+        free_Taskset(taskset);
+        free(order);
+        free(tasks);
+        return 0;
+    }
+
+    //multicore mode: global schedulers only, the uniprocessor tests do not apply
+    if(num_cores > 1)
+    {
+        printf("Schedule for global RM on %d cores:\n",num_cores);
+        simulate_global(global_rate_monotonic_scheduler,global_rate_monotonic_replay,"global-RM",taskset,num_cores,simulated,quiet,stats);
+        printf("================================================================\n");
+
+        printf("Schedule for global EDF on %d cores:\n",num_cores);
+        simulate_global(global_earliest_deadline_first_scheduler,global_earliest_deadline_first_replay,"global-EDF",taskset,num_cores,simulated,quiet,stats);
+
+        close_arrival_stream(arrivals);
+        free_Taskset(taskset);
+        free(order);
+        free(tasks);
+        return 0;
+    }
+
+    //feasibility mode: the fixed priority run and EDF only simulate their feasibility interval instead of the hyperperiod,
+    //an explicit -t or a replayed trace keeps its horizon, LLF has no known interval
+    sched_time_t fixed_horizon = simulated;
+    sched_time_t edf_horizon = simulated;
+    if(feasibility && horizon <= 0 && arrivals == NULL)
+    {
+        const char* basis;
+        sched_time_t interval = feasibility_interval(tasks,num_tasks,FEASIBILITY_FIXED_PRIORITY,order,&basis);
+        fixed_horizon = feasibility_horizon(fixed_run.name,interval,basis,hyperperiod,simulated,cap);
+        interval = feasibility_interval(tasks,num_tasks,FEASIBILITY_EDF,NULL,&basis);
+        edf_horizon = feasibility_horizon("EDF",interval,basis,hyperperiod,simulated,cap);
+    }
+
+    schedulability(tasks,num_tasks,'F',NULL);
+    schedulability(tasks,num_tasks,fixed_run.test,order);
+    if(preemption_cost > 0)
+    {
+        print_overhead_analysis(tasks,num_tasks,FEASIBILITY_FIXED_PRIORITY,order,fixed_run.name,preemption_cost);
+    }
+    simulate(fixed_run.scheduler,fixed_run.replay,fixed_run.name,taskset,fixed_horizon,quiet,stats);
+    printf("================================================================\n");
+
+    schedulability(tasks,num_tasks,'D',NULL);
+    if(preemption_cost > 0)
     {
-        int hyperperiod = calculate_hyperperiod(tasks, num_tasks);
-        int timeline[hyperperiod][2];
-        least_laxity_first(tasks,num_tasks,timeline);
-        plot_timeline(timeline,hyperperiod);
+        print_overhead_analysis(tasks,num_tasks,FEASIBILITY_EDF,NULL,"EDF",preemption_cost);
     }
+    simulate(earliest_deadline_first_scheduler,earliest_deadline_first_replay,"EDF",taskset,edf_horizon,quiet,stats);
+
+    printf("================================================================\n");
+
+    printf("Schedule for LLF:\n");
+    simulate(least_laxity_first,least_laxity_first_replay,"LLF",taskset,simulated,quiet,stats);
 
+    close_arrival_stream(arrivals);
+    free_Taskset(taskset);
+    free(order);
+    free(tasks);
 
 }
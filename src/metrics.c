@@ -0,0 +1,166 @@
+#include "../include/metrics.h"
+#include <stdlib.h>
+#include <string.h>
+
+void metrics_init(Metrics* metrics, int num_tasks)
+{
+    memset(metrics, 0, sizeof(Metrics));
+    metrics->num_tasks = num_tasks;
+    metrics->tasks = (TaskMetrics*) calloc(num_tasks > 0 ? num_tasks : 1, sizeof(TaskMetrics));
+    metrics->first_miss.task = -1;
+    for(int i = 0; i < num_tasks; i++)
+    {
+        metrics->tasks[i].min_response = SCHED_TIME_MAX;
+        metrics->tasks[i].max_lateness = -SCHED_TIME_MAX;
+        metrics->tasks[i].min_start_delay = SCHED_TIME_MAX;
+    }
+}
+
+void metrics_free(Metrics* metrics)
+{
+    free(metrics->tasks);
+    metrics->tasks = NULL;
+    metrics->num_tasks = 0;
+}
+
+static inline int bucket_of(sched_time_t value)
+{
+    if(value <= 0) return 0;
+    int bucket = 64 - __builtin_clzll((unsigned long long) value);
+    return bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1;
+}
+
+void histogram_add(Histogram* histogram, sched_time_t value)
+{
+    histogram->buckets[bucket_of(value)]++;
+    histogram->count++;
+    if(value > histogram->max) histogram->max = value;
+}
+
+//upper edge of the bucket holding the given percentile (0..100), exact to within a factor of two
+sched_time_t histogram_percentile(const Histogram* histogram, double percentile)
+{
+    if(histogram->count == 0) return 0;
+    long long rank = (long long)(percentile / 100.0 * histogram->count + 0.5);
+    if(rank < 1) rank = 1;
+    long long seen = 0;
+    for(int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+    {
+        seen += histogram->buckets[bucket];
+        if(seen >= rank)
+        {
+            if(bucket == 0) return 0;
+            sched_time_t edge = bucket < 63 ? ((sched_time_t) 1 << bucket) - 1 : SCHED_TIME_MAX;
+            return edge < histogram->max ? edge : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+static inline JobRecord job_record(const Taskset* taskset, const Job* job, sched_time_t completion)
+{
+    JobRecord record = {
+        job->task, taskset->task_id[job->task], job->instance, job->release_time, job->start_time, completion,
+        job->absolute_deadline, job->preemptions, job->migrations
+    };
+    return record;
+}
+
+static void emit(Metrics* metrics, const Taskset* taskset, const Job* job, sched_time_t completion)
+{
+    if(metrics->on_job == NULL) return;
+    JobRecord record = job_record(taskset, job, completion);
+    metrics->on_job(&record, metrics->context);
+}
+
+//a job ran to completion at the given time
+void metrics_record_job(Metrics* metrics, const Taskset* taskset, const Job* job, sched_time_t completion)
+{
+    TaskMetrics* task = &metrics->tasks[job->task];
+    sched_time_t response = completion - job->release_time;
+    sched_time_t lateness = completion - job->absolute_deadline;
+    sched_time_t start_delay = job->start_time - job->release_time;
+
+    task->completed++;
+    if(lateness > 0)
+    {
+        task->missed++;
+        if(metrics->first_miss.task < 0) metrics->first_miss = job_record(taskset, job, completion);
+    }
+    if(response < task->min_response) task->min_response = response;
+    if(response > task->max_response) task->max_response = response;
+    task->total_response += response;
+    if(lateness > task->max_lateness) task->max_lateness = lateness;
+    if(start_delay < task->min_start_delay) task->min_start_delay = start_delay;
+    if(start_delay > task->max_start_delay) task->max_start_delay = start_delay;
+
+    histogram_add(&metrics->response, response);
+    histogram_add(&metrics->tardiness, lateness);
+    emit(metrics, taskset, job, completion);
+}
+
+//a job still pending when the run ends, it counts as a miss once its deadline is inside the horizon
+void metrics_record_unfinished(Metrics* metrics, const Taskset* taskset, const Job* job, sched_time_t horizon)
+{
+    TaskMetrics* task = &metrics->tasks[job->task];
+    task->unfinished++;
+    if(job->absolute_deadline < horizon)
+    {
+        task->missed++;
+        histogram_add(&metrics->tardiness, horizon - job->absolute_deadline);
+    }
+    emit(metrics, taskset, job, -1);
+}
+
+void metrics_record_preemption(Metrics* metrics, Job* job)
+{
+    job->preemptions++;
+    metrics->tasks[job->task].preemptions++;
+}
+
+void metrics_record_migration(Metrics* metrics, Job* job)
+{
+    job->migrations++;
+    metrics->tasks[job->task].migrations++;
+}
+
+long long metrics_total_missed(const Metrics* metrics)
+{
+    long long total = 0;
+    for(int i = 0; i < metrics->num_tasks; i++) total += metrics->tasks[i].missed;
+    return total;
+}
+
+long long metrics_total_preemptions(const Metrics* metrics)
+{
+    long long total = 0;
+    for(int i = 0; i < metrics->num_tasks; i++) total += metrics->tasks[i].preemptions;
+    return total;
+}
+
+//per task table, then the context switch count and the aggregate histograms' percentiles
+void print_metrics(const Metrics* metrics, FILE* out)
+{
+    fprintf(out, "T#\tjobs\tmissed\tpending\tpreempt\tmigrate\tRmin\tRavg\tRmax\tLmax\tstart_jitter\n");
+    for(int i = 0; i < metrics->num_tasks; i++)
+    {
+        const TaskMetrics* task = &metrics->tasks[i];
+        if(task->completed == 0)
+        {
+            fprintf(out, "T%d\t0\t%lld\t%lld\t%lld\t%lld\t-\t-\t-\t-\t-\n", i, task->missed, task->unfinished, task->preemptions, task->migrations);
+            continue;
+        }
+        fprintf(out, "T%d\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\t%.1f\t%lld\t%lld\t%lld\n", i, task->completed, task->missed, task->unfinished,
+            task->preemptions, task->migrations, task->min_response, task->total_response / task->completed, task->max_response,
+            task->max_lateness, task->max_start_delay - task->min_start_delay);
+    }
+    fprintf(out, "context switches: %lld, deadline misses: %lld", metrics->context_switches, metrics_total_missed(metrics));
+    if(metrics->overhead > 0)
+    {
+        fprintf(out, ", switch overhead: %lld", metrics->overhead);
+    }
+    fprintf(out, "\n");
+    fprintf(out, "response time p50 <= %lld, p90 <= %lld, p99 <= %lld, max %lld\n",
+        histogram_percentile(&metrics->response, 50), histogram_percentile(&metrics->response, 90),
+        histogram_percentile(&metrics->response, 99), metrics->response.max);
+}
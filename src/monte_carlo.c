@@ -0,0 +1,335 @@
+#include "../include/monte_carlo.h"
+#include "../include/metrics.h"
+#include "../include/thread_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//two sided 95% quantile of the standard normal
+#define CONFIDENCE_Z 1.959963984540054
+
+const double monte_carlo_percentiles[MONTE_CARLO_PERCENTILES] = { 50, 90, 99 };
+
+//"wcet", "uniform[:low]", "normal[:mean[:spread]]" or "bimodal[:high[:low]]", false on anything else
+bool parse_execution_model(const char* spec, ExecutionModel* model)
+{
+    ExecutionModel parsed = { EXECUTION_WCET, 0.5, 0.8, 0.1, 0.05 };
+    const char* colon = strchr(spec, ':');
+    size_t name_length = colon != NULL ? (size_t)(colon - spec) : strlen(spec);
+    double values[2];
+    int count = 0;
+    while(colon != NULL && count < 2)
+    {
+        char* end;
+        values[count++] = strtod(colon + 1, &end);
+        if(end == colon + 1 || (*end != ':' && *end != '\0')) return false;
+        colon = *end == ':' ? end : NULL;
+    }
+    if(colon != NULL) return false;
+
+    if(strncmp(spec, "wcet", name_length) == 0 && name_length == 4 && count == 0)
+    {
+        parsed.distribution = EXECUTION_WCET;
+    }
+    else if(strncmp(spec, "uniform", name_length) == 0 && name_length == 7 && count <= 1)
+    {
+        parsed.distribution = EXECUTION_UNIFORM;
+        if(count > 0) parsed.low = values[0];
+    }
+    else if(strncmp(spec, "normal", name_length) == 0 && name_length == 6)
+    {
+        parsed.distribution = EXECUTION_NORMAL;
+        if(count > 0) parsed.mean = values[0];
+        if(count > 1) parsed.spread = values[1];
+    }
+    else if(strncmp(spec, "bimodal", name_length) == 0 && name_length == 7)
+    {
+        parsed.distribution = EXECUTION_BIMODAL;
+        if(count > 0) parsed.high = values[0];
+        if(count > 1) parsed.low = values[1];
+    }
+    else
+    {
+        return false;
+    }
+
+    if(parsed.low < 0 || parsed.low > 1 || parsed.mean <= 0 || parsed.spread < 0 || parsed.high < 0 || parsed.high > 1)
+    {
+        return false;
+    }
+    *model = parsed;
+    return true;
+}
+
+void describe_execution_model(const ExecutionModel* model, char* text, size_t size)
+{
+    switch(model->distribution)
+    {
+        case EXECUTION_UNIFORM:
+            snprintf(text, size, "uniform in [%.2f, 1] x WCET", model->low);
+            break;
+        case EXECUTION_NORMAL:
+            snprintf(text, size, "normal, mean %.2f sd %.2f x WCET", model->mean, model->spread);
+            break;
+        case EXECUTION_BIMODAL:
+            snprintf(text, size, "WCET with probability %.3f, %.2f x WCET otherwise", model->high, model->low);
+            break;
+        default:
+            snprintf(text, size, "WCET");
+            break;
+    }
+}
+
+//per replication figures laid out [replication][task], reduced in replication order afterwards
+//so the result is the same on any number of threads
+//response holds [replication][task][percentile], NAN for a task that completed no job in that replication
+typedef struct replication_table
+{
+    long long* jobs;
+    long long* missed;
+    double* response;
+    sched_time_t* max_response;
+} ReplicationTable;
+
+typedef struct response_log
+{
+    sched_time_t* values;
+    long long count;
+    long long capacity;
+} ResponseLog;
+
+//one thread's share of the replications, handed out one at a time, everything below the inputs is its own
+typedef struct replication_worker
+{
+    const Taskset* taskset;
+    sampled_fn scheduler;
+    const MonteCarloParams* params;
+    ReplicationTable* table;
+    int* next;
+    ResponseLog* logs;
+    long long* judged;
+} ReplicationWorker;
+
+static void log_job(const JobRecord* record, void* context)
+{
+    ReplicationWorker* worker = (ReplicationWorker*) context;
+    if(record->completion < 0)
+    {
+        if(record->deadline < worker->params->horizon) worker->judged[record->task]++;
+        return;
+    }
+    worker->judged[record->task]++;
+
+    ResponseLog* log = &worker->logs[record->task];
+    if(log->count == log->capacity)
+    {
+        log->capacity = log->capacity > 0 ? 2 * log->capacity : 64;
+        log->values = (sched_time_t*) realloc(log->values, log->capacity * sizeof(sched_time_t));
+    }
+    log->values[log->count++] = record->completion - record->release;
+}
+
+static int compare_times(const void* a, const void* b)
+{
+    sched_time_t x = *(const sched_time_t*) a;
+    sched_time_t y = *(const sched_time_t*) b;
+    return x < y ? -1 : x > y;
+}
+
+static void run_replication(ReplicationWorker* worker, int replication)
+{
+    const Taskset* taskset = worker->taskset;
+    int num_tasks = taskset->num_tasks;
+    ExecutionSampler sampler;
+    sampler.model = worker->params->model;
+    rng_seed(&sampler.rng, worker->params->seed + replication);
+
+    Metrics metrics;
+    metrics_init(&metrics, num_tasks);
+    metrics.on_job = log_job;
+    metrics.context = worker;
+    memset(worker->judged, 0, num_tasks * sizeof(long long));
+    for(int i = 0; i < num_tasks; i++)
+    {
+        worker->logs[i].count = 0;
+    }
+
+    worker->scheduler(taskset, &sampler, worker->params->horizon, NULL, &metrics);
+
+    //nearest rank percentiles over the replication's completed jobs
+    ReplicationTable* table = worker->table;
+    for(int i = 0; i < num_tasks; i++)
+    {
+        long long slot = (long long) replication * num_tasks + i;
+        ResponseLog* log = &worker->logs[i];
+        table->jobs[slot] = worker->judged[i];
+        table->missed[slot] = metrics.tasks[i].missed;
+        table->max_response[slot] = metrics.tasks[i].completed > 0 ? metrics.tasks[i].max_response : -1;
+
+        if(log->count > 1) qsort(log->values, log->count, sizeof(sched_time_t), compare_times);
+        for(int k = 0; k < MONTE_CARLO_PERCENTILES; k++)
+        {
+            long long rank = (long long) ceil(monte_carlo_percentiles[k] / 100 * log->count);
+            table->response[slot * MONTE_CARLO_PERCENTILES + k] = log->count > 0 ? (double) log->values[rank > 0 ? rank - 1 : 0] : NAN;
+        }
+    }
+    metrics_free(&metrics);
+}
+
+static void replication_work(void* arg)
+{
+    ReplicationWorker* worker = (ReplicationWorker*) arg;
+    int replication;
+    while((replication = __atomic_fetch_add(worker->next, 1, __ATOMIC_RELAXED)) < worker->params->replications)
+    {
+        run_replication(worker, replication);
+    }
+}
+
+//mean and confidence half width of values[0], values[stride], ... skipping NANs
+static Estimate estimate_of(const double values[], int count, int stride)
+{
+    double sum = 0;
+    double squares = 0;
+    int used = 0;
+    for(int r = 0; r < count; r++)
+    {
+        double value = values[(long long) r * stride];
+        if(isnan(value)) continue;
+        sum += value;
+        squares += value * value;
+        used++;
+    }
+    Estimate estimate = { used > 0 ? sum / used : NAN, 0 };
+    if(used > 1)
+    {
+        double variance = (squares - sum * sum / used) / (used - 1);
+        estimate.half_width = CONFIDENCE_Z * sqrt(variance > 0 ? variance : 0) / sqrt(used);
+    }
+    return estimate;
+}
+
+//replications independent runs of scheduler over params->horizon on params->num_threads threads
+//confidence intervals treat every replication as one sample, jobs inside a run are not independent of each other
+void monte_carlo(const Taskset* taskset, sampled_fn scheduler, const MonteCarloParams* params, MonteCarloResult* result)
+{
+    int num_tasks = taskset->num_tasks;
+    int replications = params->replications > 0 ? params->replications : 0;
+    int num_threads = params->num_threads > 0 ? params->num_threads : 1;
+    long long slots = (long long) replications * num_tasks;
+
+    ReplicationTable table;
+    table.jobs = (long long*) calloc(slots > 0 ? slots : 1, sizeof(long long));
+    table.missed = (long long*) calloc(slots > 0 ? slots : 1, sizeof(long long));
+    table.max_response = (sched_time_t*) calloc(slots > 0 ? slots : 1, sizeof(sched_time_t));
+    table.response = (double*) calloc(slots > 0 ? slots * MONTE_CARLO_PERCENTILES : 1, sizeof(double));
+
+    int next = 0;
+    ReplicationWorker* workers = (ReplicationWorker*) calloc(num_threads, sizeof(ReplicationWorker));
+    ThreadPool* pool = new_ThreadPool(num_threads);
+    for(int t = 0; t < num_threads; t++)
+    {
+        workers[t].taskset = taskset;
+        workers[t].scheduler = scheduler;
+        workers[t].params = params;
+        workers[t].table = &table;
+        workers[t].next = &next;
+        workers[t].logs = (ResponseLog*) calloc(num_tasks > 0 ? num_tasks : 1, sizeof(ResponseLog));
+        workers[t].judged = (long long*) calloc(num_tasks > 0 ? num_tasks : 1, sizeof(long long));
+        thread_pool_submit(pool, replication_work, &workers[t]);
+    }
+    thread_pool_wait(pool);
+    free_ThreadPool(pool);
+    for(int t = 0; t < num_threads; t++)
+    {
+        for(int i = 0; i < num_tasks; i++)
+        {
+            free(workers[t].logs[i].values);
+        }
+        free(workers[t].logs);
+        free(workers[t].judged);
+    }
+    free(workers);
+
+    result->num_tasks = num_tasks;
+    result->replications = replications;
+    result->tasks = (TaskEstimate*) calloc(num_tasks > 0 ? num_tasks : 1, sizeof(TaskEstimate));
+    result->failed_runs = 0;
+    for(int r = 0; r < replications; r++)
+    {
+        long long missed = 0;
+        for(int i = 0; i < num_tasks; i++) missed += table.missed[(long long) r * num_tasks + i];
+        if(missed > 0) result->failed_runs++;
+    }
+
+    double* ratios = (double*) malloc((replications > 0 ? replications : 1) * sizeof(double));
+    for(int i = 0; i < num_tasks; i++)
+    {
+        TaskEstimate* task = &result->tasks[i];
+        task->max_response = -1;
+        for(int r = 0; r < replications; r++)
+        {
+            long long slot = (long long) r * num_tasks + i;
+            task->jobs += table.jobs[slot];
+            task->missed += table.missed[slot];
+            ratios[r] = table.jobs[slot] > 0 ? (double) table.missed[slot] / table.jobs[slot] : NAN;
+            if(table.max_response[slot] > task->max_response) task->max_response = table.max_response[slot];
+        }
+        task->miss = estimate_of(ratios, replications, 1);
+        for(int k = 0; k < MONTE_CARLO_PERCENTILES; k++)
+        {
+            task->response[k] = estimate_of(&table.response[(long long) i * MONTE_CARLO_PERCENTILES + k], replications, num_tasks * MONTE_CARLO_PERCENTILES);
+        }
+    }
+    free(ratios);
+
+    //Wilson score interval, still sensible when no replication or every replication missed
+    double n = replications > 0 ? replications : 1;
+    double p = result->failed_runs / n;
+    double z2 = CONFIDENCE_Z * CONFIDENCE_Z;
+    double denominator = 1 + z2 / n;
+    double center = (p + z2 / (2 * n)) / denominator;
+    double half = CONFIDENCE_Z * sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / denominator;
+    result->run_miss = p;
+    result->run_miss_low = center - half > 0 ? center - half : 0;
+    result->run_miss_high = center + half < 1 ? center + half : 1;
+
+    free(table.jobs);
+    free(table.missed);
+    free(table.max_response);
+    free(table.response);
+}
+
+void free_MonteCarloResult(MonteCarloResult* result)
+{
+    free(result->tasks);
+    result->tasks = NULL;
+    result->num_tasks = 0;
+}
+
+//the share of runs that missed, then per task the miss probability and response percentiles as mean +- 95% half width
+void print_monte_carlo(const MonteCarloResult* result, FILE* out)
+{
+    fprintf(out, "runs with a deadline miss: %d/%d = %.4f, 95%% CI [%.4f, %.4f]\n", result->failed_runs, result->replications,
+        result->run_miss, result->run_miss_low, result->run_miss_high);
+    fprintf(out, "T#\tjobs\tmissed\tP(miss)\t\t");
+    for(int k = 0; k < MONTE_CARLO_PERCENTILES; k++)
+    {
+        fprintf(out, "R p%g\t\t", monte_carlo_percentiles[k]);
+    }
+    fprintf(out, "Rmax\n");
+    for(int i = 0; i < result->num_tasks; i++)
+    {
+        const TaskEstimate* task = &result->tasks[i];
+        fprintf(out, "T%d\t%lld\t%lld\t", i, task->jobs, task->missed);
+        if(isnan(task->miss.mean)) fprintf(out, "-\t\t");
+        else fprintf(out, "%.4f+-%.4f\t", task->miss.mean, task->miss.half_width);
+        for(int k = 0; k < MONTE_CARLO_PERCENTILES; k++)
+        {
+            if(isnan(task->response[k].mean)) fprintf(out, "-\t\t");
+            else fprintf(out, "%.1f+-%.1f\t", task->response[k].mean, task->response[k].half_width);
+        }
+        if(task->max_response < 0) fprintf(out, "-\n");
+        else fprintf(out, "%lld\n", task->max_response);
+    }
+}
@@ -0,0 +1,216 @@
+#include "../include/partition.h"
+#include "../include/analysis.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct packed_task
+{
+    double utilization;
+    int index;
+} PackedTask;
+
+//one core's share of a partitioned run, simulated on its own worker
+typedef struct core_run
+{
+    Taskset* taskset;
+    scheduler_fn scheduler;
+    sched_time_t horizon;
+    Timeline* timeline;
+    double wall_us;
+} CoreRun;
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static double utilization_of(const Task* task)
+{
+    return (double) task->execution_time / task->period;
+}
+
+//decreasing utilization, ties go to the lower index
+static int compare_packed(const void* a, const void* b)
+{
+    const PackedTask* x = (const PackedTask*) a;
+    const PackedTask* y = (const PackedTask*) b;
+    if(x->utilization != y->utilization)
+    {
+        return x->utilization > y->utilization ? -1 : 1;
+    }
+    return x->index - y->index;
+}
+
+//copy the tasks already on core plus the candidate into scratch
+static int gather(Task tasks[], int num_tasks, const int core_of[], int core, int candidate, Task scratch[])
+{
+    int count = 0;
+    for(int i = 0; i < num_tasks; i++)
+    {
+        if(core_of[i] == core || i == candidate)
+        {
+            scratch[count++] = tasks[i];
+        }
+    }
+    return count;
+}
+
+//exact uniprocessor test of core with the candidate task added
+static bool admits(Task tasks[], int num_tasks, const int core_of[], int core, int candidate, PartitionTest test, Task scratch[], int order[], sched_time_t wcrt[])
+{
+    int count = gather(tasks, num_tasks, core_of, core, candidate, scratch);
+    if(test == PARTITION_TEST_EDF)
+    {
+        return edf_demand_analysis(scratch, count, NULL);
+    }
+    priority_order(scratch, count, PRIORITY_RATE_MONOTONIC, order);
+    return response_time_analysis(scratch, count, order, wcrt);
+}
+
+//place every task on a core with first, best or worst fit decreasing
+//a core only takes a task if it stays schedulable under the exact test, a new core is opened when none does
+//at most max_cores cores are opened (0 for as many as needed), false if some task could not be placed
+bool partition_tasks(Task tasks[], int num_tasks, PartitionHeuristic heuristic, PartitionTest test, int max_cores, Partition* partition)
+{
+    int core_limit = max_cores > 0 ? max_cores : (num_tasks > 0 ? num_tasks : 1);
+    partition->num_tasks = num_tasks;
+    partition->num_cores = 0;
+    partition->unassigned = 0;
+    partition->core_of = (int*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(int));
+    partition->core_tasks = (int*) calloc(core_limit, sizeof(int));
+    partition->core_utilization = (double*) calloc(core_limit, sizeof(double));
+
+    PackedTask* packed = (PackedTask*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(PackedTask));
+    Task* scratch = (Task*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(Task));
+    int* order = (int*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(int));
+    sched_time_t* wcrt = (sched_time_t*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(sched_time_t));
+    for(int i = 0; i < num_tasks; i++)
+    {
+        partition->core_of[i] = -1;
+        packed[i].utilization = utilization_of(&tasks[i]);
+        packed[i].index = i;
+    }
+    qsort(packed, num_tasks, sizeof(PackedTask), compare_packed);
+
+    for(int p = 0; p < num_tasks; p++)
+    {
+        int task = packed[p].index;
+        int chosen = -1;
+        for(int core = 0; core < partition->num_cores; core++)
+        {
+            //utilization above 1 can never pass, skip the exact test
+            double load = partition->core_utilization[core] + packed[p].utilization;
+            if(load > 1 + 1e-9) continue;
+            if(heuristic != PARTITION_FIRST_FIT && chosen >= 0)
+            {
+                double best = partition->core_utilization[chosen];
+                double current = partition->core_utilization[core];
+                if(heuristic == PARTITION_BEST_FIT ? current <= best : current >= best) continue;
+            }
+            if(!admits(tasks, num_tasks, partition->core_of, core, task, test, scratch, order, wcrt)) continue;
+
+            chosen = core;
+            if(heuristic == PARTITION_FIRST_FIT) break;
+        }
+
+        if(chosen < 0 && partition->num_cores < core_limit
+           && admits(tasks, num_tasks, partition->core_of, partition->num_cores, task, test, scratch, order, wcrt))
+        {
+            chosen = partition->num_cores++;
+        }
+
+        if(chosen < 0)
+        {
+            partition->unassigned++;
+            continue;
+        }
+        partition->core_of[task] = chosen;
+        partition->core_tasks[chosen]++;
+        partition->core_utilization[chosen] += packed[p].utilization;
+    }
+
+    free(packed);
+    free(scratch);
+    free(order);
+    free(wcrt);
+    return partition->unassigned == 0;
+}
+
+void free_Partition(Partition* partition)
+{
+    free(partition->core_of);
+    free(partition->core_tasks);
+    free(partition->core_utilization);
+    partition->core_of = NULL;
+    partition->core_tasks = NULL;
+    partition->core_utilization = NULL;
+}
+
+static void simulate_core(void* arg)
+{
+    CoreRun* run = (CoreRun*) arg;
+    double start = now_us();
+    run->scheduler(run->taskset, run->horizon, run->timeline, NULL);
+    run->wall_us = now_us() - start;
+}
+
+//simulate every core's sub-taskset with the uniprocessor scheduler, one pool job per core
+//tasks keep their task_id so the per core timelines name the original tasks, unassigned tasks are left out
+//timelines (may be NULL) holds one timeline per core, timing (may be NULL) receives the per core and overall times
+void simulate_partitioned(Task tasks[], int num_tasks, const Partition* partition, scheduler_fn scheduler, sched_time_t horizon,
+                          int num_threads, Timeline timelines[], PartitionTiming* timing)
+{
+    int num_cores = partition->num_cores;
+    CoreRun* runs = (CoreRun*) calloc(num_cores > 0 ? num_cores : 1, sizeof(CoreRun));
+    Task* subset = (Task*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(Task));
+    for(int core = 0; core < num_cores; core++)
+    {
+        CoreRun* run = &runs[core];
+        int count = 0;
+        for(int i = 0; i < num_tasks; i++)
+        {
+            if(partition->core_of[i] == core)
+            {
+                subset[count++] = tasks[i];
+            }
+        }
+        run->taskset = new_Taskset(subset, count);
+        run->scheduler = scheduler;
+        run->horizon = horizon;
+        run->timeline = timelines != NULL ? &timelines[core] : NULL;
+    }
+
+    free(subset);
+
+    ThreadPool* pool = new_ThreadPool(num_threads);
+    double start = now_us();
+    for(int core = 0; core < num_cores; core++)
+    {
+        thread_pool_submit(pool, simulate_core, &runs[core]);
+    }
+    thread_pool_wait(pool);
+    double wall_us = now_us() - start;
+    free_ThreadPool(pool);
+
+    if(timing != NULL)
+    {
+        timing->wall_us = wall_us;
+        timing->serial_us = 0;
+        for(int core = 0; core < num_cores; core++)
+        {
+            timing->serial_us += runs[core].wall_us;
+            if(timing->core_us != NULL) timing->core_us[core] = runs[core].wall_us;
+        }
+    }
+
+    for(int core = 0; core < num_cores; core++)
+    {
+        free_Taskset(runs[core].taskset);
+    }
+    free(runs);
+}
@@ -1,83 +1,234 @@
 #include "../include/priority_queue.h"
+#include "../include/job_pool.h"
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 
-Node* new_Node(Job* data, int priority)
+#define INITIAL_CAPACITY 16
+
+//true if node a has to be served before node b
+static inline bool before(const Node* a, const Node* b)
 {
-    Node* new = (Node*) malloc(sizeof(Node));
-    new->data = data;
-    new->priority = priority;
-    new->nextnode = NULL;
-    return new;
+    if(a->priority != b->priority)
+    {
+        return a->priority < b->priority;
+    }
+    return a->sequence < b->sequence;
+}
+
+static inline void place(PriorityQueue* queue, Node* node, int index)
+{
+    queue->heap[index] = node;
+    node->index = index;
+}
+
+//move the node at index towards the root till the heap property holds
+static void sift_up(PriorityQueue* queue, int index)
+{
+    Node* node = queue->heap[index];
+    while(index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if(!before(node, queue->heap[parent]))
+        {
+            break;
+        }
+        place(queue, queue->heap[parent], index);
+        index = parent;
+    }
+    place(queue, node, index);
+}
+
+//move the node at index towards the leaves till the heap property holds
+static void sift_down(PriorityQueue* queue, int index)
+{
+    Node* node = queue->heap[index];
+    int size = queue->size;
+    while(true)
+    {
+        int child = 2 * index + 1;
+        if(child >= size)
+        {
+            break;
+        }
+        if(child + 1 < size && before(queue->heap[child + 1], queue->heap[child]))
+        {
+            child++;
+        }
+        if(!before(queue->heap[child], node))
+        {
+            break;
+        }
+        place(queue, queue->heap[child], index);
+        index = child;
+    }
+    place(queue, node, index);
 }
 
-Node* push(Node* Head, Job* data, int priority)
+//take the node out of the heap without freeing it
+static void detach(PriorityQueue* queue, Node* handle)
 {
-    Node* new = new_Node(data,priority);
+    int index = handle->index;
+    Node* last = queue->heap[--queue->size];
+    handle->index = -1;
 
-    if(Head == NULL)
+    if(last == handle)
     {
-        Head = new;
+        return;
     }
-    else if(Head->priority > new->priority)
+
+    place(queue, last, index);
+    if(index > 0 && before(last, queue->heap[(index - 1) / 2]))
     {
-        new->nextnode = Head;
-        Head = new; 
+        sift_up(queue, index);
     }
     else
     {
-        Node* cur = Head;
-        while(cur->nextnode != NULL && cur->nextnode->priority  < new->priority)
-        {
-            cur = cur->nextnode;
-        }
+        sift_down(queue, index);
+    }
+}
+
+//hand a finished job and its node back to wherever they came from
+static void release(PriorityQueue* queue, Node* node)
+{
+    if(queue->pool != NULL)
+    {
+        job_pool_free_job(queue->pool, node->data);
+        job_pool_free_node(queue->pool, node);
+    }
+    else
+    {
+        free(node->data);
+        free(node);
+    }
+}
+
+PriorityQueue* new_PriorityQueue(struct job_pool* pool)
+{
+    PriorityQueue* queue = (PriorityQueue*) malloc(sizeof(PriorityQueue));
+    queue->pool = pool;
+    queue->heap = (Node**) malloc(INITIAL_CAPACITY * sizeof(Node*));
+    queue->size = 0;
+    queue->capacity = INITIAL_CAPACITY;
+    queue->next_sequence = 0;
+    return queue;
+}
+
+//release the queue together with any jobs still waiting in it
+void free_PriorityQueue(PriorityQueue* queue)
+{
+    if(queue == NULL) return;
+    for(int i = 0; i < queue->size; i++)
+    {
+        release(queue, queue->heap[i]);
+    }
+    free(queue->heap);
+    free(queue);
+}
 
-        new->nextnode = cur->nextnode;
-        cur->nextnode = new;
+Node* new_Node(struct job_pool* pool, Job* data, sched_time_t priority)
+{
+    Node* new = pool != NULL ? job_pool_alloc_node(pool) : (Node*) malloc(sizeof(Node));
+    new->data = data;
+    new->priority = priority;
+    new->sequence = 0;
+    new->index = -1;
+    return new;
+}
+
+//insert a node that already has its sequence number
+static Node* insert(PriorityQueue* queue, Job* data, sched_time_t priority, unsigned long sequence)
+{
+    Node* new = new_Node(queue->pool,data,priority);
+    new->sequence = sequence;
+
+    if(queue->size == queue->capacity)
+    {
+        queue->capacity *= 2;
+        queue->heap = (Node**) realloc(queue->heap, queue->capacity * sizeof(Node*));
     }
 
-    return Head;
+    queue->heap[queue->size] = new;
+    sift_up(queue, queue->size++);
+
+    return new;
 }
 
-Node* pop(Node* Head)
+Node* push(PriorityQueue* queue, Job* data, sched_time_t priority)
 {
-    if (Head == NULL) return NULL;
-    Node* new_Head = Head->nextnode;
-    free(Head->data);
-    free(Head);
-    return new_Head;
+    return insert(queue, data, priority, queue->next_sequence++);
 }
 
+//put a job taken out with pop_job back, it keeps its FIFO place among equal priorities
+Node* requeue(PriorityQueue* queue, Job* data, sched_time_t priority, unsigned long sequence)
+{
+    return insert(queue, data, priority, sequence);
+}
 
-Job* peek(Node* Head)
+//remove the highest priority job and free it along with its node
+void pop(PriorityQueue* queue)
 {
-    return Head ? (Head->data) : NULL;
+    if (isEmpty(queue)) return;
+    Node* top = queue->heap[0];
+    detach(queue, top);
+    release(queue, top);
 }
 
-bool isEmpty(Node* Head)
+//remove the highest priority job and hand it to the caller, only its node is freed
+//sequence (may be NULL) receives the job's place in the FIFO order for a later requeue
+Job* pop_job(PriorityQueue* queue, unsigned long* sequence)
 {
-    return(Head == NULL);
+    if (isEmpty(queue)) return NULL;
+    Node* top = queue->heap[0];
+    Job* job = top->data;
+    if(sequence != NULL) *sequence = top->sequence;
+    detach(queue, top);
+    if(queue->pool != NULL) job_pool_free_node(queue->pool, top); else free(top);
+    return job;
 }
 
-Node* rebuild_with_laxity(Node* Head, int current_time)
+Job* peek(PriorityQueue* queue)
 {
+    return isEmpty(queue) ? NULL : queue->heap[0]->data;
+}
 
-    // laxity = absolute_deadline - current_time - remaining_execution_time
+Node* peek_node(PriorityQueue* queue)
+{
+    return isEmpty(queue) ? NULL : queue->heap[0];
+}
 
-    Node* cur_node = Head;
-    Node* new_queue_head = NULL;
+//the node that would be at the top after a pop, it is always one of the root's children
+Node* peek_second_node(PriorityQueue* queue)
+{
+    if(queue->size < 2) return NULL;
+    if(queue->size == 2) return queue->heap[1];
+    return before(queue->heap[1], queue->heap[2]) ? queue->heap[1] : queue->heap[2];
+}
 
-    while(cur_node != NULL)
-    {
-        Job* cur_job = cur_node->data;
-        Node* next_node = cur_node->nextnode;
-        int laxity = cur_job->absolute_deadline - cur_job->remaining_execution_time - current_time;
-        new_queue_head = push(new_queue_head,cur_job,laxity);
-        free(cur_node);
-        cur_node = next_node;
-    }
+bool isEmpty(PriorityQueue* queue)
+{
+    return(queue == NULL || queue->size == 0);
+}
 
-    return new_queue_head;
+//raise the priority of a queued job, priorities only move towards the top
+void decrease_key(PriorityQueue* queue, Node* handle, sched_time_t priority)
+{
+    if(priority > handle->priority) return;
+    handle->priority = priority;
+    sift_up(queue, handle->index);
 }
 
+//lower the priority of a queued job, priorities only move towards the leaves
+void increase_key(PriorityQueue* queue, Node* handle, sched_time_t priority)
+{
+    if(priority < handle->priority) return;
+    handle->priority = priority;
+    sift_down(queue, handle->index);
+}
+
+//drop a queued job by its handle and free it
+void remove_node(PriorityQueue* queue, Node* handle)
+{
+    detach(queue, handle);
+    release(queue, handle);
+}
@@ -0,0 +1,115 @@
+#include "../include/release_queue.h"
+#include <stdlib.h>
+#include <stdbool.h>
+
+static inline bool earlier(ReleaseQueue* queue, int a, int b)
+{
+    sched_time_t time_a = queue->next_release[a];
+    sched_time_t time_b = queue->next_release[b];
+    if(time_a != time_b)
+    {
+        return time_a < time_b;
+    }
+    return a < b;
+}
+
+static void sift_up(ReleaseQueue* queue, int index)
+{
+    int task = queue->heap[index];
+    while(index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if(!earlier(queue, task, queue->heap[parent]))
+        {
+            break;
+        }
+        queue->heap[index] = queue->heap[parent];
+        index = parent;
+    }
+    queue->heap[index] = task;
+}
+
+static void sift_down(ReleaseQueue* queue, int index)
+{
+    int task = queue->heap[index];
+    while(true)
+    {
+        int child = 2 * index + 1;
+        if(child >= queue->size)
+        {
+            break;
+        }
+        if(child + 1 < queue->size && earlier(queue, queue->heap[child + 1], queue->heap[child]))
+        {
+            child++;
+        }
+        if(!earlier(queue, queue->heap[child], task))
+        {
+            break;
+        }
+        queue->heap[index] = queue->heap[child];
+        index = child;
+    }
+    queue->heap[index] = task;
+}
+
+//every task starts out queued at the run's next release for it
+ReleaseQueue* new_ReleaseQueue(RunContext* context)
+{
+    int num_tasks = context->taskset->num_tasks;
+    ReleaseQueue* queue = (ReleaseQueue*) malloc(sizeof(ReleaseQueue));
+    queue->next_release = context->next_release;
+    queue->period = context->taskset->period;
+    queue->heap = (int*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(int));
+    queue->size = num_tasks;
+
+    for(int i = 0; i < num_tasks; i++)
+    {
+        queue->heap[i] = i;
+    }
+    for(int i = num_tasks / 2 - 1; i >= 0; i--)
+    {
+        sift_down(queue, i);
+    }
+    return queue;
+}
+
+void free_ReleaseQueue(ReleaseQueue* queue)
+{
+    if(queue == NULL) return;
+    free(queue->heap);
+    free(queue);
+}
+
+//earliest pending release, or the horizon if nothing is pending before it
+sched_time_t next_release_time(ReleaseQueue* queue, sched_time_t horizon)
+{
+    if(queue->size == 0) return horizon;
+    sched_time_t time = queue->next_release[queue->heap[0]];
+    return time < horizon ? time : horizon;
+}
+
+//take out the index of every task releasing at or before time, in task order
+//the caller hands each task back with schedule_release once its job is out
+int pop_due_releases(ReleaseQueue* queue, sched_time_t time, int released[])
+{
+    int count = 0;
+    while(queue->size > 0 && queue->next_release[queue->heap[0]] <= time)
+    {
+        released[count++] = queue->heap[0];
+        queue->heap[0] = queue->heap[--queue->size];
+        if(queue->size > 0)
+        {
+            sift_down(queue, 0);
+        }
+    }
+    return count;
+}
+
+//queue the task's release one period after the last one
+void schedule_release(ReleaseQueue* queue, int task)
+{
+    queue->next_release[task] += queue->period[task];
+    queue->heap[queue->size] = task;
+    sift_up(queue, queue->size++);
+}
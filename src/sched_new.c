@@ -1,157 +1,192 @@
 #include "../include/task.h"
 #include "../include/utils.h"
 #include "../include/priority_queue.h"
+#include "../include/timeline.h"
+#include "../include/release_queue.h"
+#include "../include/arrival_stream.h"
+#include "../include/sched_new.h"
+#include "../include/trace.h"
 #include <math.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <stddef.h>
+#include <string.h>
 
 
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
 
-//rate monotonic scheduler
-//task level fixed priority => higher the time period, lower the priority
-//decision points: arrival of new job | finish execution of current job
-void rate_monotonic_scheduler(Task tasks[], int num_tasks, int timeline[][2])
+//engine and policies are always inlined into the public schedulers,
+//so every hook below turns into a direct (mostly inlined) call and the hot loop has no indirect calls
+#define ENGINE_INLINE static inline __attribute__((always_inline))
+
+//what tells one scheduler apart from the next
+//key: priority a job is queued with when it is released, lower runs first
+//charge: optional, updates the running job's key after it ran for executed time units without finishing
+//extra_decision_point: optional, a decision point the policy needs besides releases and completions
+//keyed_on_remaining: the key depends on the remaining execution, so a preemption cost added to it re-keys the job
+typedef struct sched_policy
 {
-    int hyperperiod = calculate_hyperperiod(tasks,num_tasks);
-    int time = 0;
-    Node* Head = NULL;
-    Job* executing_job = NULL;
+    sched_time_t (*key)(const Taskset* taskset, Job* job, sched_time_t time);
+    void (*charge)(PriorityQueue* ready_queue, Node* running, sched_time_t executed);
+    sched_time_t (*extra_decision_point)(PriorityQueue* ready_queue, sched_time_t time, sched_time_t horizon);
+    bool keyed_on_remaining;
+} SchedPolicy;
+
 
-    
-    while (time < hyperperiod)
+//add the jobs released by time into the ready queue, simultaneous releases come out as one batch
+//jobs come from the periodic release queue, or from a recorded trace when arrivals is not NULL
+ENGINE_INLINE void release_jobs(const SchedPolicy* policy, RunContext* context, ReleaseQueue* release_queue, ArrivalStream* arrivals,
+                                int released[], JobPool* job_pool, PriorityQueue* ready_queue, sched_time_t time, int core)
+{
+    (void) core; //only read by the trace hooks
+    const Taskset* taskset = context->taskset;
+    if (arrivals != NULL)
     {
-        //add the jobs that have arrived into the ready queue
-        for (int i = 0; i < num_tasks; i++)
+        Arrival arrival;
+        while (pop_due_arrival(arrivals, time, &arrival))
         {
-            if (tasks[i].next_arrival_time == time)
-            {
-                // allocate memory for the new incoming job and initialize its variables
-                Job *cur_job = allocate_job(&tasks[i], time);
-                // push the current job onto the priority queue and keep track of the head
-                Head = push(Head, cur_job, tasks[i].period);
-
-                //increment the instance counter
-                tasks[i].instance_counter++;
+            int task = arrival.task_id;
 
-                // update the next arrival time in task struct
-                tasks[i].next_arrival_time += tasks[i].period;
-            }
-        }
-        
-        // the job that has the highest priority and is executing
-        executing_job = peek(Head);
-        
-        // finding the time when the current job finishes executing
-        int cur_finish_execution = executing_job != NULL ? time + executing_job->remaining_execution_time : hyperperiod;
-        
-        // finding when the next job arrives
-        int next_job_arrival = hyperperiod;
-        for (int i = 0; i < num_tasks; i++)
-        {
-            next_job_arrival = next_job_arrival < tasks[i].next_arrival_time ? next_job_arrival : tasks[i].next_arrival_time;
+            //a recorded job runs for what it took in the trace, not the task's worst case
+            Job *cur_job = allocate_job(job_pool, taskset, task, context->instances[task]++, time);
+            cur_job->actual_execution_time = arrival.execution_time;
+            cur_job->remaining_execution_time = arrival.execution_time;
+            push(ready_queue, cur_job, policy->key(taskset, cur_job, time));
+            TRACE_EVENT(TRACE_RELEASE, time, taskset, cur_job, core, 0);
         }
-        
-        //find the next decision point and move time to the next decision point
-        int next_decision_point = MIN(next_job_arrival,cur_finish_execution);
-        
+        return;
+    }
 
-        //setup the timline array to print out the variables
-        for(int i = time; i < next_decision_point; i++)
-        {
-            if(executing_job != NULL)
-            {
-                //set it to the task_id if the cpu 
-                timeline[i][0] = executing_job->job_task->task_id;
-                timeline[i][1] = executing_job->job_task->instance_counter; 
-            }
-            else
-            {
-                timeline[i][0] = -1;
-                timeline[i][1] = -1;
-            }
-        }
+    int num_released = pop_due_releases(release_queue, time, released);
+    for (int i = 0; i < num_released; i++)
+    {
+        int task = released[i];
 
-        //if the CPU was not idle, upadte the remaining time for the current running task
-        //run the task till that time and pop the queue if the task finishes executing
-        if (executing_job != NULL)
+        // allocate memory for the new incoming job, it takes the next instance number of its task
+        Job *cur_job = allocate_job(job_pool, taskset, task, context->instances[task]++, time);
+        //a Monte Carlo run draws what this job actually takes, anywhere up to the WCET
+        if (context->sampler != NULL)
         {
-            executing_job->remaining_execution_time -= (next_decision_point - time);
-            if(executing_job->remaining_execution_time <=0)
-            {
-                Head = pop(Head);
-            }
+            cur_job->actual_execution_time = sample_execution_time(context->sampler, taskset->execution_time[task]);
+            cur_job->remaining_execution_time = cur_job->actual_execution_time;
         }
-        
+        // push the current job onto the priority queue with the policy's key
+        push(ready_queue, cur_job, policy->key(taskset, cur_job, time));
+        TRACE_EVENT(TRACE_RELEASE, time, taskset, cur_job, core, 0);
 
-        //move time to next decision point
-        time = next_decision_point;
+        // queue the task's next release one period later
+        schedule_release(release_queue, task);
     }
 }
 
+ENGINE_INLINE sched_time_t next_release(ReleaseQueue* release_queue, ArrivalStream* arrivals, sched_time_t horizon)
+{
+    return arrivals != NULL ? next_arrival_time(arrivals, horizon) : next_release_time(release_queue, horizon);
+}
 
-//earliest deadline first scheduler
-//job level fixed priority => farther the absolute deadline, lower the priority
-//decision points: arrival of new job | finish execution of current job
-void earliest_deadline_first_scheduler(Task tasks[], int num_tasks, int timeline[][2])
+//the release / peek / advance / log loop shared by every uniprocessor policy
+//simulates [0, horizon), the timeline and metrics may be NULL when they are not wanted
+//or less when the metrics ask to stop at the first deadline miss
+//every piece of state the run writes is its own, the taskset is only read
+ENGINE_INLINE void run_scheduler(const SchedPolicy* policy, const Taskset* taskset, ArrivalStream* arrivals, ExecutionSampler* sampler,
+                                 sched_time_t horizon, Timeline* timeline, Metrics* metrics)
 {
-    int hyperperiod = calculate_hyperperiod(tasks,num_tasks);
-    int time = 0;
-    Node* Head = NULL;
+    sched_time_t time = 0;
+    RunContext context;
+    init_run_context(&context, taskset);
+    context.sampler = sampler;
+    JobPool* job_pool = new_JobPool();
+    PriorityQueue* ready_queue = new_PriorityQueue(job_pool);
+    ReleaseQueue* release_queue = new_ReleaseQueue(&context);
+    int* released = (int*) malloc((taskset->num_tasks > 0 ? taskset->num_tasks : 1) * sizeof(int));
     Job* executing_job = NULL;
 
-    
-    while (time < hyperperiod)
+    //the job that ran over the previous stretch and has not finished, NULL after a completion or idle stretch
+    Job* previous_job = NULL;
+    Node* previous_node = NULL;
+
+    while (time < horizon)
     {
         //add the jobs that have arrived into the ready queue
-        for (int i = 0; i < num_tasks; i++)
+        release_jobs(policy, &context, release_queue, arrivals, released, job_pool, ready_queue, time, 0);
+
+        // the job that has the highest priority and is executing
+        Node* executing_node = peek_node(ready_queue);
+
+        //floating non-preemptive region: the running job asked to give way keeps the cpu for up to its region more
+        if (previous_job != NULL && executing_node->data != previous_job && taskset->non_preemptive_region != NULL)
         {
-            if (tasks[i].next_arrival_time == time)
+            if (previous_job->preemptable_at < 0)
+            {
+                previous_job->preemptable_at = time + taskset->non_preemptive_region[previous_job->task];
+            }
+            if (time < previous_job->preemptable_at)
             {
-                // allocate memory for the new incoming job and initialize its variables
-                Job *cur_job = allocate_job(&tasks[i], time);
-                // push the current job onto the priority queue and keep track of the head
-                Head = push(Head, cur_job, cur_job->absolute_deadline);
+                executing_node = previous_node;
+            }
+        }
+        executing_job = executing_node != NULL ? executing_node->data : NULL;
 
-                //increment the instance counter
-                tasks[i].instance_counter++;
+        //a different job taking the cpu is a context switch, and a preemption if the previous one is not done
+        if (executing_job != NULL && executing_job != previous_job)
+        {
+            if (previous_job != NULL)
+            {
+                TRACE_EVENT(TRACE_PREEMPT, time, taskset, previous_job, 0, 0);
+                if (metrics != NULL) metrics_record_preemption(metrics, previous_job);
+            }
+            TRACE_EVENT(TRACE_DISPATCH, time, taskset, executing_job, 0, 0);
+            if (metrics != NULL) metrics->context_switches++;
+            executing_job->preemptable_at = -1;
+            if (executing_job->start_time < 0)
+            {
+                executing_job->start_time = time;
 
-                // update the next arrival time in task struct
-                tasks[i].next_arrival_time += tasks[i].period;
+                //from its first dispatch on a job only gives way to jobs keyed below its preemption threshold
+                if (taskset->preemption_threshold != NULL && taskset->preemption_threshold[executing_job->task] < executing_node->priority)
+                {
+                    decrease_key(ready_queue, executing_node, taskset->preemption_threshold[executing_job->task]);
+                }
+            }
+            //a started job that was not running was preempted, it pays for getting the cpu back,
+            //a policy whose key follows the remaining execution sees the cost in its key as well
+            else if (taskset->preemption_cost > 0)
+            {
+                executing_job->remaining_execution_time += taskset->preemption_cost;
+                if (metrics != NULL) metrics->overhead += taskset->preemption_cost;
+                if (policy->keyed_on_remaining)
+                {
+                    sched_time_t key = policy->key(taskset, executing_job, time);
+                    if (key < executing_node->priority) decrease_key(ready_queue, executing_node, key);
+                }
             }
         }
-        
-        // the job that has the highest priority and is executing
-        executing_job = peek(Head);
-        
+
         // finding the time when the current job finishes executing
-        int cur_finish_execution = executing_job != NULL ? time + executing_job->remaining_execution_time : hyperperiod;
-        
+        sched_time_t cur_finish_execution = executing_job != NULL ? time + executing_job->remaining_execution_time : horizon;
+
         // finding when the next job arrives
-        int next_job_arrival = hyperperiod;
-        for (int i = 0; i < num_tasks; i++)
+        sched_time_t next_job_arrival = next_release(release_queue, arrivals, horizon);
+
+        //find the next decision point and move time to the next decision point
+        sched_time_t next_decision_point = MIN(next_job_arrival, cur_finish_execution);
+        if (policy->extra_decision_point != NULL)
         {
-            next_job_arrival = next_job_arrival < tasks[i].next_arrival_time ? next_job_arrival : tasks[i].next_arrival_time;
+            next_decision_point = MIN(next_decision_point, policy->extra_decision_point(ready_queue, time, horizon));
+        }
+        if (executing_job != NULL && executing_job->preemptable_at > time)
+        {
+            next_decision_point = MIN(next_decision_point, executing_job->preemptable_at);
         }
-        
-        //find the next decision point and move time to the next decision point
-        int next_decision_point = MIN(next_job_arrival, cur_finish_execution);
-        
 
-        //setup the timline array to print out the variables
-        for(int i = time; i < next_decision_point; i++)
+        //log the stretch till the next decision point as one segment, idle if no job is ready
+        if(executing_job != NULL)
         {
-            if(executing_job != NULL)
-            {
-                //set it to the task_id if the cpu 
-                timeline[i][0] = executing_job->job_task->task_id;
-                timeline[i][1] = executing_job->job_task->instance_counter; 
-            }
-            else
-            {
-                timeline[i][0] = -1;
-                timeline[i][1] = -1;
-            }
+            timeline_append(timeline, time, next_decision_point, taskset->task_id[executing_job->task], executing_job->instance);
+        }
+        else
+        {
+            timeline_append(timeline, time, next_decision_point, -1, -1);
         }
 
         //if the CPU was not idle, upadte the remaining time for the current running task
@@ -159,99 +194,529 @@ void earliest_deadline_first_scheduler(Task tasks[], int num_tasks, int timeline
         if (executing_job != NULL)
         {
             executing_job->remaining_execution_time -= (next_decision_point - time);
+            previous_job = executing_job;
+            previous_node = executing_node;
             if(executing_job->remaining_execution_time <=0)
             {
-                Head = pop(Head);
+                TRACE_EVENT(TRACE_COMPLETE, next_decision_point, taskset, executing_job, 0, 0);
+                if (next_decision_point > executing_job->absolute_deadline)
+                {
+                    TRACE_EVENT(TRACE_MISS, next_decision_point, taskset, executing_job, 0, next_decision_point - executing_job->absolute_deadline);
+                }
+                if (metrics != NULL)
+                {
+                    metrics_record_job(metrics, taskset, executing_job, next_decision_point);
+
+                    //the first miss answers the feasibility question, the run ends with this completion
+                    if (metrics->stop_at_miss && next_decision_point > executing_job->absolute_deadline)
+                    {
+                        horizon = next_decision_point;
+                    }
+                }
+                previous_job = NULL;
+                remove_node(ready_queue, executing_node);
+            }
+            else if (policy->charge != NULL)
+            {
+                policy->charge(ready_queue, executing_node, next_decision_point - time);
+                TRACE_EVENT(TRACE_REKEY, next_decision_point, taskset, executing_job, 0, executing_node->priority);
             }
         }
-        
+        else
+        {
+            previous_job = NULL;
+        }
 
         //move time to next decision point
         time = next_decision_point;
     }
+
+    //whatever is still queued never finished
+    for (int i = 0; metrics != NULL && i < ready_queue->size; i++)
+    {
+        metrics_record_unfinished(metrics, taskset, ready_queue->heap[i]->data, horizon);
+    }
+
+    free_PriorityQueue(ready_queue);
+    free_ReleaseQueue(release_queue);
+    free(released);
+    free_JobPool(job_pool);
+    free_run_context(&context);
 }
 
-//least laxity first scheduler
-//job level dynamic priority => higher the slack time, lower the priority
-//decision points: arrival of new job | finish execution of current job | a job in ready queue gets laxity lesser than the currently running job
-void least_laxity_first(Task tasks[], int num_tasks, int timeline[][2])
+
+//one cpu of the global engine, idle cores have job == NULL
+//by_rank / by_finish are the core's slots in the two core heaps
+typedef struct core
 {
-    int hyperperiod = calculate_hyperperiod(tasks, num_tasks);
-    int time = 0;
-    Node* Head = NULL;
-    Job* executing_job = NULL;
+    Job* job;
+    sched_time_t priority;
+    unsigned long sequence;
+    sched_time_t finish;
+    sched_time_t since;
+    int by_rank;
+    int by_finish;
+} Core;
+
+//heap over core indices, the comparator core_heap_fix is called with decides which core comes out on top
+typedef struct core_heap
+{
+    int* heap;
+    int size;
+    size_t slot;
+} CoreHeap;
 
-    while (time < hyperperiod)
+typedef bool (*core_order)(const Core* cores, int a, int b);
+
+//the core to hand the next job to: idle cores first, then the one running the lowest priority job
+ENGINE_INLINE bool lower_ranked(const Core* cores, int a, int b)
+{
+    const Core* x = &cores[a];
+    const Core* y = &cores[b];
+    if((x->job == NULL) != (y->job == NULL)) return x->job == NULL;
+    if(x->job != NULL && (x->priority != y->priority || x->sequence != y->sequence))
     {
-        // Rebuild the ready queue at the start of a decision point
-        // This recalculates laxity for all waiting jobs
-        Head = rebuild_with_laxity(Head, time);
+        return x->priority != y->priority ? x->priority > y->priority : x->sequence > y->sequence;
+    }
+    return a < b;
+}
 
-        // Add the jobs that have arrived into the ready queue
-        for (int i = 0; i < num_tasks; i++)
+//the core whose job completes first, idle cores never complete
+ENGINE_INLINE bool finishes_first(const Core* cores, int a, int b)
+{
+    if(cores[a].finish != cores[b].finish) return cores[a].finish < cores[b].finish;
+    return a < b;
+}
+
+static inline int* core_slot(Core* cores, const CoreHeap* heap, int core)
+{
+    return (int*)((char*)&cores[core] + heap->slot);
+}
+
+static inline void core_place(Core* cores, CoreHeap* heap, int core, int index)
+{
+    heap->heap[index] = core;
+    *core_slot(cores, heap, core) = index;
+}
+
+//restore the heap after the key of core changed, it can only have moved one way
+//inlined with a constant comparator like the policies, so the sift steps compare without an indirect call
+ENGINE_INLINE void core_heap_fix(core_order before, Core* cores, CoreHeap* heap, int core)
+{
+    int index = *core_slot(cores, heap, core);
+    while(index > 0 && before(cores, core, heap->heap[(index - 1) / 2]))
+    {
+        core_place(cores, heap, heap->heap[(index - 1) / 2], index);
+        index = (index - 1) / 2;
+    }
+    while(true)
+    {
+        int child = 2 * index + 1;
+        if(child >= heap->size) break;
+        if(child + 1 < heap->size && before(cores, heap->heap[child + 1], heap->heap[child])) child++;
+        if(!before(cores, heap->heap[child], core)) break;
+        core_place(cores, heap, heap->heap[child], index);
+        index = child;
+    }
+    core_place(cores, heap, core, index);
+}
+
+//close the segment the core ran since its last change, then give it job (NULL to idle it)
+ENGINE_INLINE void switch_core(const Taskset* taskset, Core* cores, int core, Job* job, sched_time_t priority, unsigned long sequence,
+                               sched_time_t time, Timeline timelines[], CoreStats stats[])
+{
+    Core* cpu = &cores[core];
+    if(cpu->job != NULL)
+    {
+        if(stats != NULL) stats[core].busy_time += time - cpu->since;
+        if(timelines != NULL) timeline_append(&timelines[core], cpu->since, time, taskset->task_id[cpu->job->task], cpu->job->instance);
+    }
+    else if(timelines != NULL)
+    {
+        timeline_append(&timelines[core], cpu->since, time, -1, -1);
+    }
+
+    cpu->job = job;
+    cpu->priority = priority;
+    cpu->sequence = sequence;
+    cpu->finish = job != NULL ? time + job->remaining_execution_time : SCHED_TIME_MAX;
+    cpu->since = time;
+}
+
+//global scheduling on num_cores identical cores: at every instant the num_cores best ready jobs run
+//cores are kept in two heaps, by the rank of their job and by completion time, and each core's run only
+//gets logged when its job changes, so a decision point costs O(log n + log m) per job that starts, stops or moves
+//a running job's remaining time is only brought up to date when it leaves its core
+ENGINE_INLINE void run_global_scheduler(const SchedPolicy* policy, const Taskset* taskset, int num_cores, ArrivalStream* arrivals,
+                                        ExecutionSampler* sampler, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics)
+{
+    sched_time_t time = 0;
+    RunContext context;
+    init_run_context(&context, taskset);
+    context.sampler = sampler;
+    JobPool* job_pool = new_JobPool();
+    PriorityQueue* ready_queue = new_PriorityQueue(job_pool);
+    ReleaseQueue* release_queue = new_ReleaseQueue(&context);
+    int* released = (int*) malloc((taskset->num_tasks > 0 ? taskset->num_tasks : 1) * sizeof(int));
+
+    Core* cores = (Core*) calloc(num_cores, sizeof(Core));
+    CoreHeap by_rank = { (int*) malloc(num_cores * sizeof(int)), num_cores, offsetof(Core, by_rank) };
+    CoreHeap by_finish = { (int*) malloc(num_cores * sizeof(int)), num_cores, offsetof(Core, by_finish) };
+    for(int c = 0; c < num_cores; c++)
+    {
+        cores[c].finish = SCHED_TIME_MAX;
+        core_place(cores, &by_rank, c, c);
+        core_place(cores, &by_finish, c, c);
+    }
+    if(stats != NULL) memset(stats, 0, num_cores * sizeof(CoreStats));
+
+    while (time < horizon)
+    {
+        //retire every job that completed by now, its core goes idle
+        while (cores[by_finish.heap[0]].finish <= time)
         {
-            if (tasks[i].next_arrival_time == time)
+            int core = by_finish.heap[0];
+            Job* done = cores[core].job;
+            TRACE_EVENT(TRACE_COMPLETE, cores[core].finish, taskset, done, core, 0);
+            if (cores[core].finish > done->absolute_deadline)
+            {
+                TRACE_EVENT(TRACE_MISS, cores[core].finish, taskset, done, core, cores[core].finish - done->absolute_deadline);
+            }
+            if (metrics != NULL)
             {
-                Job *cur_job = allocate_job(&tasks[i], time);
-                
-                // FIX 3: Push new jobs with their initial LAXITY, not deadline.
-                int initial_laxity = cur_job->absolute_deadline - time - cur_job->remaining_execution_time;
-                Head = push(Head, cur_job, initial_laxity);
-
-                tasks[i].instance_counter++;
-                tasks[i].next_arrival_time += tasks[i].period;
+                metrics_record_job(metrics, taskset, done, cores[core].finish);
+                if (metrics->stop_at_miss && cores[core].finish > done->absolute_deadline)
+                {
+                    horizon = time;
+                }
             }
+            switch_core(taskset, cores, core, NULL, 0, 0, time, timelines, stats);
+            job_pool_free_job(job_pool, done);
+            core_heap_fix(lower_ranked, cores, &by_rank, core);
+            core_heap_fix(finishes_first, cores, &by_finish, core);
         }
 
-        executing_job = peek(Head);
-        
-        // Find decision points
-        int cur_finish_execution = (executing_job != NULL) ? (time + executing_job->remaining_execution_time) : hyperperiod;
-        
-        int next_job_arrival = hyperperiod;
-        for (int i = 0; i < num_tasks; i++)
+        //stopped at the first miss, every completion at this instant is in
+        if (time >= horizon)
         {
-            next_job_arrival = next_job_arrival < tasks[i].next_arrival_time ? next_job_arrival : tasks[i].next_arrival_time;
+            break;
         }
 
-        // calculate the time where minimum laxity change occurs
-        int preemption_time = hyperperiod;
-        if (executing_job != NULL && Head->nextnode != NULL)
-        {
-            int laxity_diff = Head->nextnode->priority - Head->priority;
-            preemption_time = time + laxity_diff + 1; 
-        }
+        //add the jobs that have arrived into the ready queue
+        release_jobs(policy, &context, release_queue, arrivals, released, job_pool, ready_queue, time, -1);
 
-        int next_decision_point = MIN(cur_finish_execution, MIN(next_job_arrival, preemption_time));
-        
-        // Fill the timeline array
-        for (int i = time; i < next_decision_point; i++)
+        //hand the best waiting job to the lowest ranked core while it beats that core's job
+        while (!isEmpty(ready_queue))
         {
-            if (executing_job != NULL)
+            Node* best = peek_node(ready_queue);
+            int core = by_rank.heap[0];
+            Core* cpu = &cores[core];
+            if (cpu->job != NULL && (best->priority > cpu->priority || (best->priority == cpu->priority && best->sequence > cpu->sequence)))
             {
-                timeline[i][0] = executing_job->job_task->task_id;
-                timeline[i][1] = executing_job->job_task->instance_counter;
+                break;
             }
-            else
+
+            sched_time_t priority = best->priority;
+            unsigned long sequence;
+            Job* job = pop_job(ready_queue, &sequence);
+
+            //a preempted job goes back to the ready queue with what it has left
+            Job* preempted = cpu->job;
+            if (preempted != NULL)
             {
-                timeline[i][0] = -1; // CPU Idle
-                timeline[i][1] = -1;
+                preempted->remaining_execution_time = cpu->finish - time;
+                preempted->last_core = core;
+                requeue(ready_queue, preempted, cpu->priority, cpu->sequence);
+                if(stats != NULL) stats[core].preemptions++;
+                if(metrics != NULL) metrics_record_preemption(metrics, preempted);
+                TRACE_EVENT(TRACE_PREEMPT, time, taskset, preempted, core, 0);
             }
-        }
 
-        // Update the state of the executing job
-        if (executing_job != NULL)
-        {
-            executing_job->remaining_execution_time -= (next_decision_point - time);
-            if (executing_job->remaining_execution_time <= 0)
+            //a preempted job pays for getting a cpu back, and for moving when it is another one
+            if (job->last_core >= 0)
+            {
+                sched_time_t overhead = taskset->preemption_cost;
+                if (job->last_core != core)
+                {
+                    TRACE_EVENT(TRACE_MIGRATE, time, taskset, job, core, job->last_core);
+                    if(stats != NULL) stats[core].migrations++;
+                    if(metrics != NULL) metrics_record_migration(metrics, job);
+                    overhead += taskset->migration_cost;
+                }
+                job->remaining_execution_time += overhead;
+                if(metrics != NULL) metrics->overhead += overhead;
+            }
+            TRACE_EVENT(TRACE_DISPATCH, time, taskset, job, core, 0);
+            if (metrics != NULL)
             {
-               
-                Head = pop(Head);
+                metrics->context_switches++;
+                if (job->start_time < 0) job->start_time = time;
             }
+            switch_core(taskset, cores, core, job, priority, sequence, time, timelines, stats);
+            core_heap_fix(lower_ranked, cores, &by_rank, core);
+            core_heap_fix(finishes_first, cores, &by_finish, core);
         }
-        
-      
-        time = next_decision_point;
+
+        //every core moves on to the next release or the first completion, whichever comes first
+        sched_time_t next_decision_point = MIN(next_release(release_queue, arrivals, horizon), cores[by_finish.heap[0]].finish);
+        time = MIN(next_decision_point, horizon);
+    }
+
+    //close the last segment of every core, jobs still running or queued never finished
+    for (int c = 0; c < num_cores; c++)
+    {
+        if (metrics != NULL && cores[c].job != NULL)
+        {
+            if (cores[c].finish <= horizon) metrics_record_job(metrics, taskset, cores[c].job, cores[c].finish);
+            else metrics_record_unfinished(metrics, taskset, cores[c].job, horizon);
+        }
+        switch_core(taskset, cores, c, NULL, 0, 0, horizon, timelines, stats);
+    }
+    for (int i = 0; metrics != NULL && i < ready_queue->size; i++)
+    {
+        metrics_record_unfinished(metrics, taskset, ready_queue->heap[i]->data, horizon);
     }
+
+    free(cores);
+    free(by_rank.heap);
+    free(by_finish.heap);
+    free_PriorityQueue(ready_queue);
+    free_ReleaseQueue(release_queue);
+    free(released);
+    free_JobPool(job_pool);
+    free_run_context(&context);
+}
+
+
+ENGINE_INLINE sched_time_t rate_monotonic_key(const Taskset* taskset, Job* job, sched_time_t time)
+{
+    (void) time;
+    return taskset->period[job->task];
+}
+
+ENGINE_INLINE sched_time_t deadline_monotonic_key(const Taskset* taskset, Job* job, sched_time_t time)
+{
+    (void) time;
+    return taskset->relative_deadline[job->task];
+}
+
+ENGINE_INLINE sched_time_t fixed_priority_key(const Taskset* taskset, Job* job, sched_time_t time)
+{
+    (void) time;
+    return taskset->priority[job->task];
 }
 
+ENGINE_INLINE sched_time_t earliest_deadline_key(const Taskset* taskset, Job* job, sched_time_t time)
+{
+    (void) taskset;
+    (void) time;
+    return job->absolute_deadline;
+}
+
+ENGINE_INLINE sched_time_t fifo_key(const Taskset* taskset, Job* job, sched_time_t time)
+{
+    (void) taskset;
+    (void) time;
+    return job->release_time;
+}
+
+// laxity = absolute_deadline - current_time - remaining_execution_time
+// every job's laxity drops by one per time unit it waits, so jobs are keyed by the time invariant
+// absolute_deadline - remaining_execution_time and the laxity order at any instant is the key order
+ENGINE_INLINE sched_time_t least_laxity_key(const Taskset* taskset, Job* job, sched_time_t time)
+{
+    (void) taskset;
+    (void) time;
+    return job->absolute_deadline - job->remaining_execution_time;
+}
+
+// only the running job's key moves, it grows by the time it ran, O(log n)
+ENGINE_INLINE void least_laxity_charge(PriorityQueue* ready_queue, Node* running, sched_time_t executed)
+{
+    increase_key(ready_queue, running, running->priority + executed);
+}
+
+// the running job keeps its laxity while the runner up loses one unit per time unit,
+// the runner up takes over once their laxities meet if it wins the FIFO tie, one unit later otherwise
+ENGINE_INLINE sched_time_t least_laxity_decision_point(PriorityQueue* ready_queue, sched_time_t time, sched_time_t horizon)
+{
+    Node* runner_up = peek_second_node(ready_queue);
+    if (runner_up == NULL)
+    {
+        return horizon;
+    }
+    Node* running = peek_node(ready_queue);
+    sched_time_t laxity_diff = runner_up->priority - running->priority;
+    return time + laxity_diff + (runner_up->sequence < running->sequence ? 0 : 1);
+}
+
+
+//rate monotonic scheduler
+//task level fixed priority => higher the time period, lower the priority
+//decision points: arrival of new job | finish execution of current job
+void rate_monotonic_scheduler(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { rate_monotonic_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, NULL, NULL, horizon, timeline, metrics);
+}
+
+//deadline monotonic scheduler
+//task level fixed priority => longer the relative deadline, lower the priority
+//decision points: arrival of new job | finish execution of current job
+void deadline_monotonic_scheduler(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { deadline_monotonic_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, NULL, NULL, horizon, timeline, metrics);
+}
+
+//fixed priority scheduler
+//task level fixed priority => whatever order assign_priorities gave the taskset, rate monotonic without one
+//decision points: arrival of new job | finish execution of current job
+void fixed_priority_scheduler(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { fixed_priority_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, NULL, NULL, horizon, timeline, metrics);
+}
+
+//earliest deadline first scheduler
+//job level fixed priority => farther the absolute deadline, lower the priority
+//decision points: arrival of new job | finish execution of current job
+void earliest_deadline_first_scheduler(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { earliest_deadline_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, NULL, NULL, horizon, timeline, metrics);
+}
+
+//first in first out scheduler
+//job level fixed priority => later the release, lower the priority, a running job is never preempted
+//decision points: arrival of new job | finish execution of current job
+void fifo_scheduler(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { fifo_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, NULL, NULL, horizon, timeline, metrics);
+}
+
+//least laxity first scheduler
+//job level dynamic priority => higher the slack time, lower the priority
+//decision points: arrival of new job | finish execution of current job | a job in ready queue gets laxity lesser than the currently running job
+void least_laxity_first(const Taskset* taskset, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { least_laxity_key, least_laxity_charge, least_laxity_decision_point, true };
+    run_scheduler(&policy, taskset, NULL, NULL, horizon, timeline, metrics);
+}
+
+//global rate monotonic on num_cores cores, timelines and stats are per core and may be NULL
+void global_rate_monotonic_scheduler(const Taskset* taskset, int num_cores, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics)
+{
+    static const SchedPolicy policy = { rate_monotonic_key, NULL, NULL, false };
+    run_global_scheduler(&policy, taskset, num_cores, NULL, NULL, horizon, timelines, stats, metrics);
+}
+
+//global deadline monotonic on num_cores cores
+void global_deadline_monotonic_scheduler(const Taskset* taskset, int num_cores, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics)
+{
+    static const SchedPolicy policy = { deadline_monotonic_key, NULL, NULL, false };
+    run_global_scheduler(&policy, taskset, num_cores, NULL, NULL, horizon, timelines, stats, metrics);
+}
+
+//global earliest deadline first on num_cores cores
+void global_earliest_deadline_first_scheduler(const Taskset* taskset, int num_cores, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics)
+{
+    static const SchedPolicy policy = { earliest_deadline_key, NULL, NULL, false };
+    run_global_scheduler(&policy, taskset, num_cores, NULL, NULL, horizon, timelines, stats, metrics);
+}
+
+//the same policies fed from a recorded arrival trace instead of the periodic releases,
+//every job runs for its recorded execution time and is due relative_deadline after its recorded release
+void rate_monotonic_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { rate_monotonic_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, arrivals, NULL, horizon, timeline, metrics);
+}
+
+void deadline_monotonic_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { deadline_monotonic_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, arrivals, NULL, horizon, timeline, metrics);
+}
+
+void fixed_priority_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { fixed_priority_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, arrivals, NULL, horizon, timeline, metrics);
+}
+
+void earliest_deadline_first_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { earliest_deadline_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, arrivals, NULL, horizon, timeline, metrics);
+}
+
+void fifo_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { fifo_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, arrivals, NULL, horizon, timeline, metrics);
+}
+
+void least_laxity_first_replay(const Taskset* taskset, ArrivalStream* arrivals, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { least_laxity_key, least_laxity_charge, least_laxity_decision_point, true };
+    run_scheduler(&policy, taskset, arrivals, NULL, horizon, timeline, metrics);
+}
+
+void global_rate_monotonic_replay(const Taskset* taskset, int num_cores, ArrivalStream* arrivals, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics)
+{
+    static const SchedPolicy policy = { rate_monotonic_key, NULL, NULL, false };
+    run_global_scheduler(&policy, taskset, num_cores, arrivals, NULL, horizon, timelines, stats, metrics);
+}
+
+void global_deadline_monotonic_replay(const Taskset* taskset, int num_cores, ArrivalStream* arrivals, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics)
+{
+    static const SchedPolicy policy = { deadline_monotonic_key, NULL, NULL, false };
+    run_global_scheduler(&policy, taskset, num_cores, arrivals, NULL, horizon, timelines, stats, metrics);
+}
+
+void global_earliest_deadline_first_replay(const Taskset* taskset, int num_cores, ArrivalStream* arrivals, sched_time_t horizon, Timeline timelines[], CoreStats stats[], Metrics* metrics)
+{
+    static const SchedPolicy policy = { earliest_deadline_key, NULL, NULL, false };
+    run_global_scheduler(&policy, taskset, num_cores, arrivals, NULL, horizon, timelines, stats, metrics);
+}
+
+//the same uniprocessor policies with every periodic job's actual execution time drawn by sampler,
+//one run per sampler at a time, Monte Carlo replications each bring their own
+void rate_monotonic_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { rate_monotonic_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, NULL, sampler, horizon, timeline, metrics);
+}
+
+void deadline_monotonic_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { deadline_monotonic_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, NULL, sampler, horizon, timeline, metrics);
+}
+
+void fixed_priority_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { fixed_priority_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, NULL, sampler, horizon, timeline, metrics);
+}
+
+void earliest_deadline_first_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { earliest_deadline_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, NULL, sampler, horizon, timeline, metrics);
+}
+
+void fifo_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { fifo_key, NULL, NULL, false };
+    run_scheduler(&policy, taskset, NULL, sampler, horizon, timeline, metrics);
+}
+
+//laxity is worked out from the job's drawn remaining time, as with a replayed trace
+void least_laxity_first_sampled(const Taskset* taskset, ExecutionSampler* sampler, sched_time_t horizon, Timeline* timeline, Metrics* metrics)
+{
+    static const SchedPolicy policy = { least_laxity_key, least_laxity_charge, least_laxity_decision_point, true };
+    run_scheduler(&policy, taskset, NULL, sampler, horizon, timeline, metrics);
+}
@@ -0,0 +1,319 @@
+#include "../include/sensitivity.h"
+#include "../include/analysis.h"
+#include "../include/thread_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//what every probe of one analysis shares, read only while probes run
+//base_first: first job completion per RM level with the tasks as given, levels above a changed task keep it
+//failing_level: first RM level that misses with the tasks as given, num_tasks if none does
+typedef struct sensitivity_context
+{
+    Task* tasks;
+    int num_tasks;
+    SensitivityTest test;
+    int* order;
+    int* rank;
+    sched_time_t* base_first;
+    int failing_level;
+} SensitivityContext;
+
+//one candidate point, its scratch arrays live as long as the analysis so probes allocate nothing
+//seed: lower bounds on each RM level's first completion, taken from a smaller probe that passed
+//(execution times only grew since, so every completion can only be later)
+typedef struct probe
+{
+    const SensitivityContext* context;
+    Task* tasks;
+    sched_time_t* first;
+    const sched_time_t* seed;
+    int from;
+    double alpha;
+    bool schedulable;
+} Probe;
+
+static Probe* new_probes(const SensitivityContext* context, int count)
+{
+    Probe* probes = (Probe*) calloc(count, sizeof(Probe));
+    for(int p = 0; p < count; p++)
+    {
+        probes[p].context = context;
+        probes[p].tasks = (Task*) malloc(context->num_tasks * sizeof(Task));
+        probes[p].first = (sched_time_t*) calloc(context->num_tasks, sizeof(sched_time_t));
+        memcpy(probes[p].tasks, context->tasks, context->num_tasks * sizeof(Task));
+    }
+    return probes;
+}
+
+static void free_probes(Probe* probes, int count)
+{
+    for(int p = 0; p < count; p++)
+    {
+        free(probes[p].tasks);
+        free(probes[p].first);
+    }
+    free(probes);
+}
+
+//exact test of probe->tasks, under RM only the levels from probe->from down are analysed,
+//the ones above are the same as in the tasks as given
+static bool run_probe(Probe* probe)
+{
+    const SensitivityContext* context = probe->context;
+    if(context->test == SENSITIVITY_TEST_EDF)
+    {
+        return edf_demand_analysis(probe->tasks, context->num_tasks, NULL);
+    }
+
+    if(context->failing_level < probe->from)
+    {
+        return false;
+    }
+    for(int level = probe->from; level < context->num_tasks; level++)
+    {
+        Task* task = &probe->tasks[context->order[level]];
+        sched_time_t previous = level == 0 ? 0 : level == probe->from ? context->base_first[level - 1] : probe->first[level - 1];
+        sched_time_t start = previous + task->execution_time;
+        if(probe->seed != NULL && probe->seed[level] > start) start = probe->seed[level];
+
+        sched_time_t response = level_response_time(probe->tasks, context->order, level, start, &probe->first[level]);
+        if(response > task->relative_deadline)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline sched_time_t scaled(sched_time_t execution_time, double alpha)
+{
+    sched_time_t value = (sched_time_t) ceil(alpha * execution_time);
+    return value > 0 ? value : 1;
+}
+
+static void scaling_probe(void* arg)
+{
+    Probe* probe = (Probe*) arg;
+    const SensitivityContext* context = probe->context;
+    for(int i = 0; i < context->num_tasks; i++)
+    {
+        probe->tasks[i].execution_time = scaled(context->tasks[i].execution_time, probe->alpha);
+    }
+    probe->from = 0;
+    probe->schedulable = run_probe(probe);
+}
+
+//critical scaling factor: (P + 1)-ary search with P = num_threads, every round checks P evenly spaced points
+//in parallel and keeps the stretch between the largest one that passes and the one above it
+//schedulability only gets worse as alpha grows, so no point above a failing one needs checking
+static double critical_scaling(const SensitivityContext* context, ThreadPool* pool, int num_threads, double precision)
+{
+    double utilization = 0;
+    double high = INFINITY;
+    for(int i = 0; i < context->num_tasks; i++)
+    {
+        Task* task = &context->tasks[i];
+        utilization += (double) task->execution_time / task->period;
+        double limit = (double) task->relative_deadline / task->execution_time;
+        if(limit < high) high = limit;
+    }
+    //past 1/U the demand outgrows the cpu, past D_i / C_i a job outgrows its deadline
+    if(utilization > 0 && 1 / utilization < high) high = 1 / utilization;
+
+    Probe* probes = new_probes(context, num_threads);
+    probes[0].alpha = high;
+    scaling_probe(&probes[0]);
+    if(probes[0].schedulable)
+    {
+        free_probes(probes, num_threads);
+        return high;
+    }
+
+    double low = 0;
+    sched_time_t* seed = (sched_time_t*) calloc(context->num_tasks, sizeof(sched_time_t));
+    while(high - low > precision)
+    {
+        for(int p = 0; p < num_threads; p++)
+        {
+            probes[p].alpha = low + (high - low) * (p + 1) / (num_threads + 1);
+            probes[p].seed = seed;
+            thread_pool_submit(pool, scaling_probe, &probes[p]);
+        }
+        thread_pool_wait(pool);
+
+        int passed = -1;
+        while(passed + 1 < num_threads && probes[passed + 1].schedulable) passed++;
+        if(passed >= 0)
+        {
+            low = probes[passed].alpha;
+            memcpy(seed, probes[passed].first, context->num_tasks * sizeof(sched_time_t));
+        }
+        if(passed + 1 < num_threads)
+        {
+            high = probes[passed + 1].alpha;
+        }
+    }
+
+    //the verdict only depends on the rounded execution times, so it holds up to the end of low's step:
+    //the first alpha where one of them rounds up again, which is the exact factor once the search is fine enough
+    double step_end = high;
+    for(int i = 0; i < context->num_tasks && low > 0; i++)
+    {
+        sched_time_t execution_time = context->tasks[i].execution_time;
+        double end = (double) scaled(execution_time, low) / execution_time;
+        if(end < step_end) step_end = end;
+    }
+    if(low > 0 && step_end > low) low = step_end;
+
+    free(seed);
+    free_probes(probes, num_threads);
+    return low;
+}
+
+//per task searches, handed out one task at a time to num_threads workers with a probe each
+typedef struct task_searches
+{
+    const sched_time_t* upper;
+    sched_time_t* result;
+    int num_tasks;
+    int next;
+} TaskSearches;
+
+typedef struct search_worker
+{
+    Probe* probe;
+    TaskSearches* searches;
+} SearchWorker;
+
+//largest C_i in [0, upper] that passes with the others unchanged, by binary search
+//under RM only the task's own level and the ones below it are redone per probe
+static sched_time_t search_task(Probe* probe, int task, sched_time_t upper, sched_time_t seed[])
+{
+    const SensitivityContext* context = probe->context;
+    probe->from = context->test == SENSITIVITY_TEST_RM ? context->rank[task] : 0;
+    probe->seed = seed;
+    memset(seed, 0, context->num_tasks * sizeof(sched_time_t));
+
+    sched_time_t low = 0;
+    sched_time_t high = upper + 1;
+    while(high - low > 1)
+    {
+        sched_time_t mid = low + (high - low) / 2;
+        probe->tasks[task].execution_time = mid;
+        if(run_probe(probe))
+        {
+            low = mid;
+            memcpy(seed + probe->from, probe->first + probe->from, (context->num_tasks - probe->from) * sizeof(sched_time_t));
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    probe->tasks[task].execution_time = context->tasks[task].execution_time;
+    return low;
+}
+
+static void search_work(void* arg)
+{
+    SearchWorker* worker = (SearchWorker*) arg;
+    TaskSearches* searches = worker->searches;
+    sched_time_t* seed = (sched_time_t*) malloc(searches->num_tasks * sizeof(sched_time_t));
+    int task;
+    while((task = __atomic_fetch_add(&searches->next, 1, __ATOMIC_RELAXED)) < searches->num_tasks)
+    {
+        searches->result[task] = search_task(worker->probe, task, searches->upper[task], seed);
+    }
+    free(seed);
+}
+
+//critical scaling factor and per task execution time headroom of a taskset under RM or EDF, built on the exact tests only
+//num_threads probes run side by side, precision is how close the scaling factor is pinned down
+//returns whether the taskset as given is schedulable
+bool sensitivity_analysis(Task tasks[], int num_tasks, SensitivityTest test, int num_threads, double precision, Sensitivity* result)
+{
+    if(num_threads < 1) num_threads = 1;
+    result->num_tasks = num_tasks;
+    result->scaling = 0;
+    result->max_execution = (sched_time_t*) calloc(num_tasks > 0 ? num_tasks : 1, sizeof(sched_time_t));
+    if(num_tasks == 0)
+    {
+        return true;
+    }
+
+    SensitivityContext context = { tasks, num_tasks, test, NULL, NULL, NULL, num_tasks };
+    if(test == SENSITIVITY_TEST_RM)
+    {
+        context.order = (int*) malloc(num_tasks * sizeof(int));
+        context.rank = (int*) malloc(num_tasks * sizeof(int));
+        context.base_first = (sched_time_t*) calloc(num_tasks, sizeof(sched_time_t));
+        priority_order(tasks, num_tasks, PRIORITY_RATE_MONOTONIC, context.order);
+        for(int level = 0; level < num_tasks; level++)
+        {
+            context.rank[context.order[level]] = level;
+        }
+
+        //the tasks as given, level by level, so every search knows what the levels above it do
+        sched_time_t previous = 0;
+        for(int level = 0; level < num_tasks; level++)
+        {
+            Task* task = &tasks[context.order[level]];
+            sched_time_t response = level_response_time(tasks, context.order, level, previous + task->execution_time, &context.base_first[level]);
+            previous = context.base_first[level];
+            if(response > task->relative_deadline && context.failing_level == num_tasks)
+            {
+                context.failing_level = level;
+            }
+        }
+    }
+
+    Probe* base = new_probes(&context, 1);
+    bool schedulable = run_probe(base);
+    free_probes(base, 1);
+
+    ThreadPool* pool = new_ThreadPool(num_threads);
+    result->scaling = critical_scaling(&context, pool, num_threads, precision);
+
+    double utilization = 0;
+    for(int i = 0; i < num_tasks; i++)
+    {
+        utilization += (double) tasks[i].execution_time / tasks[i].period;
+    }
+    sched_time_t* upper = (sched_time_t*) malloc(num_tasks * sizeof(sched_time_t));
+    for(int i = 0; i < num_tasks; i++)
+    {
+        //above the deadline or the share of the cpu the others leave, the task can not fit
+        double others = utilization - (double) tasks[i].execution_time / tasks[i].period;
+        double share = ceil(tasks[i].period * (1 - others));
+        upper[i] = tasks[i].relative_deadline;
+        if(share < upper[i]) upper[i] = share > 0 ? (sched_time_t) share : 0;
+    }
+
+    TaskSearches searches = { upper, result->max_execution, num_tasks, 0 };
+    Probe* probes = new_probes(&context, num_threads);
+    SearchWorker* workers = (SearchWorker*) malloc(num_threads * sizeof(SearchWorker));
+    for(int t = 0; t < num_threads; t++)
+    {
+        workers[t].probe = &probes[t];
+        workers[t].searches = &searches;
+        thread_pool_submit(pool, search_work, &workers[t]);
+    }
+    thread_pool_wait(pool);
+
+    free(workers);
+    free_probes(probes, num_threads);
+    free(upper);
+    free_ThreadPool(pool);
+    free(context.order);
+    free(context.rank);
+    free(context.base_first);
+    return schedulable;
+}
+
+void free_Sensitivity(Sensitivity* sensitivity)
+{
+    free(sensitivity->max_execution);
+    sensitivity->max_execution = NULL;
+    sensitivity->num_tasks = 0;
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "../include/task.h"
+#include "../include/taskset_io.h"
+#include "../include/sensitivity.h"
+#include "../include/thread_pool.h"
+
+//how close the critical scaling factor is pinned down by default
+#define DEFAULT_PRECISION 1e-4
+
+static void usage(const char* program)
+{
+    printf("usage %s [-p rm|edf|all] [-j threads] [-e precision] <filename.txt>\n",program);
+}
+
+static void report(const char* name, Task tasks[], int num_tasks, SensitivityTest test, int num_threads, double precision)
+{
+    Sensitivity sensitivity;
+    bool schedulable = sensitivity_analysis(tasks, num_tasks, test, num_threads, precision, &sensitivity);
+
+    printf("%s: %s, critical scaling factor %.4f",name,schedulable ? "schedulable" : "not schedulable",sensitivity.scaling);
+    if(sensitivity.scaling >= 1)
+    {
+        printf(" (execution times can grow by %.2f%%)\n",(sensitivity.scaling - 1) * 100);
+    }
+    else
+    {
+        printf(" (execution times have to shrink by %.2f%%)\n",(1 - sensitivity.scaling) * 100);
+    }
+
+    printf("T#\tC\tCmax\tslack\n");
+    for(int i = 0; i < num_tasks; i++)
+    {
+        if(sensitivity.max_execution[i] == 0)
+        {
+            printf("T%d\t%lld\t-\t-\n",i,tasks[i].execution_time);
+            continue;
+        }
+        printf("T%d\t%lld\t%lld\t%lld\n",i,tasks[i].execution_time,sensitivity.max_execution[i],sensitivity.max_execution[i] - tasks[i].execution_time);
+    }
+    free_Sensitivity(&sensitivity);
+}
+
+//how much the execution times of a taskset can grow before it fails, from the exact tests only, nothing is simulated
+//Cmax is the largest execution time a task can take with every other task unchanged, '-' when no value fits
+int main(int argc, char* argv[])
+{
+    const char* policy = "all";
+    int num_threads = default_thread_count();
+    double precision = DEFAULT_PRECISION;
+    int option;
+
+    while((option = getopt(argc, argv, "p:j:e:")) != -1)
+    {
+        switch(option)
+        {
+            case 'p': policy = optarg; break;
+            case 'j': num_threads = atoi(optarg); break;
+            case 'e': precision = atof(optarg); break;
+            default:
+                usage(argv[0]);
+                return -1;
+        }
+    }
+    bool rm = strcmp(policy, "rm") == 0 || strcmp(policy, "all") == 0;
+    bool edf = strcmp(policy, "edf") == 0 || strcmp(policy, "llf") == 0 || strcmp(policy, "all") == 0;
+    if(optind >= argc || (!rm && !edf) || precision <= 0)
+    {
+        usage(argv[0]);
+        return -1;
+    }
+
+    int num_tasks = 0;
+    Task* tasks = load_taskset(argv[optind], &num_tasks);
+    if(tasks == NULL)
+    {
+        return -2;
+    }
+
+    if(rm)
+    {
+        report("RM", tasks, num_tasks, SENSITIVITY_TEST_RM, num_threads, precision);
+    }
+    if(rm && edf)
+    {
+        printf("================================================================\n");
+    }
+    if(edf)
+    {
+        //LLF is optimal on one cpu just like EDF, the same exact test answers for both
+        report("EDF and LLF", tasks, num_tasks, SENSITIVITY_TEST_EDF, num_threads, precision);
+    }
+
+    free(tasks);
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include "../include/taskgen.h"
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+
+//uunifast-discard gives up after this many draws with a utilization above 1
+#define UUNIFAST_ATTEMPTS 1000
+
+void taskgen_default_params(TaskgenParams* params)
+{
+    params->num_tasks = 10;
+    params->utilization = 0.7;
+    params->method = TASKGEN_UUNIFAST;
+    params->period_min = 10;
+    params->period_max = 1000;
+    params->period_granularity = 1;
+    params->hyperperiod_limit = 0;
+    params->deadline_ratio_min = 1.0;
+    params->deadline_ratio_max = 1.0;
+}
+
+//uunifast (Bini & Buttazzo), n utilizations summing to utilization, uniform over the simplex
+//for a total above 1 draws with a share above 1 are thrown away (uunifast-discard)
+bool uunifast(Rng* rng, int n, double utilization, double out[])
+{
+    for(int attempt = 0; attempt < UUNIFAST_ATTEMPTS; attempt++)
+    {
+        double remaining = utilization;
+        bool valid = true;
+        for(int i = 0; i < n - 1; i++)
+        {
+            double next = remaining * pow(rng_uniform(rng), 1.0 / (n - 1 - i));
+            out[i] = remaining - next;
+            remaining = next;
+            if(out[i] > 1) valid = false;
+        }
+        out[n - 1] = remaining;
+        if(remaining > 1) valid = false;
+
+        if(valid) return true;
+    }
+    return false;
+}
+
+//randfixedsum (Stafford, as used by Emberson et al.), n values in [0, 1] summing to utilization,
+//uniform over that polytope, works for any total up to n without discarding
+//tables are indexed from 1 to stay close to the published algorithm, they take O(n^2) memory
+bool randfixedsum(Rng* rng, int n, double utilization, double out[])
+{
+    if(n < 1 || utilization < 0 || utilization > n) return false;
+    if(n == 1)
+    {
+        out[0] = utilization;
+        return true;
+    }
+
+    double s = utilization;
+    int k = (int) floor(s);
+    if(k > n - 1) k = n - 1;
+    if(k < 0) k = 0;
+    if(s < k) s = k;
+    if(s > k + 1) s = k + 1;
+
+    double* s1 = (double*) malloc((n + 1) * sizeof(double));
+    double* s2 = (double*) malloc((n + 1) * sizeof(double));
+    for(int i = 1; i <= n; i++)
+    {
+        s1[i] = s - (k - i + 1);
+        s2[i] = (k + n - i + 1) - s;
+    }
+
+    //w is n x (n+1), t is (n-1) x n, both 1 indexed
+    int w_columns = n + 2;
+    double* w = (double*) calloc((size_t)(n + 1) * w_columns, sizeof(double));
+    double* t = (double*) calloc((size_t)(n + 1) * (n + 1), sizeof(double));
+    if(w == NULL || t == NULL)
+    {
+        free(w);
+        free(t);
+        free(s1);
+        free(s2);
+        return false;
+    }
+    #define W(r,c) w[(r) * w_columns + (c)]
+    #define T(r,c) t[(r) * (n + 1) + (c)]
+
+    double tiny = DBL_TRUE_MIN;
+    W(1,2) = DBL_MAX;
+    for(int i = 2; i <= n; i++)
+    {
+        for(int c = 1; c <= i; c++)
+        {
+            double tmp1 = W(i-1,c+1) * s1[c] / i;
+            double tmp2 = W(i-1,c) * s2[n-i+c] / i;
+            W(i,c+1) = tmp1 + tmp2;
+            double tmp3 = W(i,c+1) + tiny;
+            T(i-1,c) = s2[n-i+c] > s1[c] ? tmp2 / tmp3 : 1 - tmp1 / tmp3;
+        }
+    }
+
+    double sum = 0;
+    double product = 1;
+    int j = k + 1;
+    for(int i = n - 1; i >= 1; i--)
+    {
+        int e = rng_uniform(rng) <= T(i,j) ? 1 : 0;
+        double sx = pow(rng_uniform(rng), 1.0 / i);
+        sum += (1 - sx) * product * s / (i + 1);
+        product *= sx;
+        out[n - i - 1] = sum + product * e;
+        s -= e;
+        j -= e;
+    }
+    out[n - 1] = sum + product * s;
+
+    #undef W
+    #undef T
+    free(w);
+    free(t);
+    free(s1);
+    free(s2);
+
+    //the construction orders the coordinates, shuffle them (fisher yates)
+    for(int i = n - 1; i > 0; i--)
+    {
+        int other = (int)(rng_uniform(rng) * (i + 1));
+        double swap = out[i];
+        out[i] = out[other];
+        out[other] = swap;
+    }
+    return true;
+}
+
+static int compare_time(const void* a, const void* b)
+{
+    sched_time_t x = *(const sched_time_t*) a;
+    sched_time_t y = *(const sched_time_t*) b;
+    return (x > y) - (x < y);
+}
+
+//sorted divisors of limit that lie in [low, high]
+static sched_time_t* divisors_in_range(sched_time_t limit, sched_time_t low, sched_time_t high, int* count)
+{
+    int capacity = 64;
+    sched_time_t* divisors = (sched_time_t*) malloc(capacity * sizeof(sched_time_t));
+    *count = 0;
+    for(sched_time_t d = 1; d * d <= limit; d++)
+    {
+        if(limit % d != 0) continue;
+        sched_time_t pair[2] = { d, limit / d };
+        for(int p = 0; p < (pair[0] == pair[1] ? 1 : 2); p++)
+        {
+            if(pair[p] < low || pair[p] > high) continue;
+            if(*count == capacity)
+            {
+                capacity *= 2;
+                divisors = (sched_time_t*) realloc(divisors, capacity * sizeof(sched_time_t));
+            }
+            divisors[(*count)++] = pair[p];
+        }
+    }
+    qsort(divisors, *count, sizeof(sched_time_t), compare_time);
+    return divisors;
+}
+
+//closest entry of a sorted array in log distance
+static sched_time_t snap_to(const sched_time_t values[], int count, double target)
+{
+    int low = 0, high = count - 1;
+    while(low < high)
+    {
+        int mid = (low + high) / 2;
+        if(values[mid] < target) low = mid + 1; else high = mid;
+    }
+    if(low > 0 && fabs(log(values[low - 1]) - log(target)) < fabs(log(values[low]) - log(target)))
+    {
+        low--;
+    }
+    return values[low];
+}
+
+//draw a synthetic taskset, NULL if the utilization split or the period range can not be satisfied
+Task* generate_taskset(const TaskgenParams* params, Rng* rng, int* num_tasks)
+{
+    int n = params->num_tasks;
+    if(n < 1 || params->period_min < 1 || params->period_max < params->period_min)
+    {
+        return NULL;
+    }
+
+    double* utilizations = (double*) malloc(n * sizeof(double));
+    bool split = params->method == TASKGEN_RANDFIXEDSUM
+        ? randfixedsum(rng, n, params->utilization, utilizations)
+        : uunifast(rng, n, params->utilization, utilizations);
+    if(!split)
+    {
+        free(utilizations);
+        return NULL;
+    }
+
+    int num_divisors = 0;
+    sched_time_t* divisors = NULL;
+    if(params->hyperperiod_limit > 0)
+    {
+        divisors = divisors_in_range(params->hyperperiod_limit, params->period_min, params->period_max, &num_divisors);
+        if(num_divisors == 0)
+        {
+            free(divisors);
+            free(utilizations);
+            return NULL;
+        }
+    }
+
+    Task* tasks = (Task*) malloc(n * sizeof(Task));
+    double log_min = log((double) params->period_min);
+    double log_max = log((double) params->period_max);
+    sched_time_t granularity = params->period_granularity > 0 ? params->period_granularity : 1;
+
+    for(int i = 0; i < n; i++)
+    {
+        double raw = exp(log_min + rng_uniform(rng) * (log_max - log_min));
+        sched_time_t period;
+        if(divisors != NULL)
+        {
+            period = snap_to(divisors, num_divisors, raw);
+        }
+        else
+        {
+            period = (sched_time_t) llround(raw / granularity) * granularity;
+            if(period < granularity) period = granularity;
+        }
+
+        sched_time_t execution = (sched_time_t) llround(utilizations[i] * period);
+        if(execution < 1) execution = 1;
+        if(execution > period) execution = period;
+
+        double ratio = params->deadline_ratio_min + rng_uniform(rng) * (params->deadline_ratio_max - params->deadline_ratio_min);
+        sched_time_t deadline = (sched_time_t) llround(ratio * period);
+        if(deadline < execution) deadline = execution;
+
+        tasks[i].task_id = i;
+        tasks[i].arrival_time = 0;
+        tasks[i].period = period;
+        tasks[i].execution_time = execution;
+        tasks[i].relative_deadline = deadline;
+    }
+
+    free(divisors);
+    free(utilizations);
+    *num_tasks = n;
+    return tasks;
+}
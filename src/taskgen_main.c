@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../include/task.h"
+#include "../include/taskgen.h"
+#include "../include/taskset_io.h"
+#include "../include/rng.h"
+
+//parses "low:high", a single value sets both ends
+static bool parse_range(const char* text, double* low, double* high)
+{
+    char* end;
+    *low = strtod(text, &end);
+    if(end == text) return false;
+    *high = *end == ':' ? strtod(end + 1, NULL) : *low;
+    return *high >= *low;
+}
+
+static void usage(const char* program)
+{
+    printf("usage %s [-n tasks] [-u utilization] [-m uunifast|randfixedsum] [-p min:max period] [-g period granularity]\n",program);
+    printf("      [-H hyperperiod limit] [-d min:max deadline/period ratio] [-s seed] [-c count] [-o directory]\n");
+}
+
+//writes count tasksets to <directory>/taskset_<i>.txt, or a single one to stdout without -o
+int main(int argc, char* argv[])
+{
+    TaskgenParams params;
+    taskgen_default_params(&params);
+    unsigned long long seed = 1;
+    int count = 1;
+    const char* directory = NULL;
+    double low, high;
+    int option;
+
+    while((option = getopt(argc, argv, "n:u:m:p:g:H:d:s:c:o:")) != -1)
+    {
+        switch(option)
+        {
+            case 'n': params.num_tasks = atoi(optarg); break;
+            case 'u': params.utilization = atof(optarg); break;
+            case 'm':
+                if(strcmp(optarg, "uunifast") == 0) params.method = TASKGEN_UUNIFAST;
+                else if(strcmp(optarg, "randfixedsum") == 0) params.method = TASKGEN_RANDFIXEDSUM;
+                else { usage(argv[0]); return -1; }
+                break;
+            case 'p':
+                if(!parse_range(optarg, &low, &high)) { usage(argv[0]); return -1; }
+                params.period_min = (sched_time_t) low;
+                params.period_max = (sched_time_t) high;
+                break;
+            case 'g': params.period_granularity = atoll(optarg); break;
+            case 'H': params.hyperperiod_limit = atoll(optarg); break;
+            case 'd':
+                if(!parse_range(optarg, &params.deadline_ratio_min, &params.deadline_ratio_max)) { usage(argv[0]); return -1; }
+                break;
+            case 's': seed = strtoull(optarg, NULL, 10); break;
+            case 'c': count = atoi(optarg); break;
+            case 'o': directory = optarg; break;
+            default:
+                usage(argv[0]);
+                return -1;
+        }
+    }
+
+    if(directory == NULL && count != 1)
+    {
+        fprintf(stderr,"[ERROR]: more than one taskset needs an output directory (-o)\n");
+        return -1;
+    }
+    if(directory != NULL)
+    {
+        mkdir(directory, 0755);
+    }
+
+    Rng rng;
+    rng_seed(&rng, seed);
+    for(int i = 0; i < count; i++)
+    {
+        int num_tasks = 0;
+        Task* tasks = generate_taskset(&params, &rng, &num_tasks);
+        if(tasks == NULL)
+        {
+            fprintf(stderr,"[ERROR]: no taskset with %d tasks, U=%f and periods in [%lld, %lld] could be drawn\n",
+                params.num_tasks, params.utilization, params.period_min, params.period_max);
+            return -2;
+        }
+
+        bool written;
+        if(directory != NULL)
+        {
+            char path[4096];
+            snprintf(path, sizeof(path), "%s/taskset_%d.txt", directory, i);
+            FILE* file = fopen(path, "w");
+            if(file == NULL)
+            {
+                fprintf(stderr,"[ERROR]: Error opening %s\n",path);
+                free(tasks);
+                return -2;
+            }
+            written = write_taskset(file, tasks, num_tasks);
+            fclose(file);
+        }
+        else
+        {
+            written = write_taskset(stdout, tasks, num_tasks);
+        }
+        free(tasks);
+        if(!written) return -2;
+    }
+    return 0;
+}
@@ -0,0 +1,377 @@
+#include "../include/taskset_io.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef enum scan_result
+{
+    SCAN_OK,
+    SCAN_END,
+    SCAN_BAD,
+    SCAN_OVERFLOW
+} ScanResult;
+
+//cursor over a mapped text file, line is only kept for error messages
+typedef struct scanner
+{
+    const char* cursor;
+    const char* end;
+    int line;
+} Scanner;
+
+//read the next whitespace separated integer
+static ScanResult scan_integer(Scanner* scanner, long long* value)
+{
+    const char* p = scanner->cursor;
+    const char* end = scanner->end;
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+    {
+        if(*p == '\n') scanner->line++;
+        p++;
+    }
+    if(p == end)
+    {
+        scanner->cursor = p;
+        return SCAN_END;
+    }
+
+    bool negative = false;
+    if(*p == '-' || *p == '+')
+    {
+        negative = *p == '-';
+        p++;
+    }
+    if(p == end || *p < '0' || *p > '9')
+    {
+        scanner->cursor = p;
+        return SCAN_BAD;
+    }
+
+    //18 digits always fit in 64 bits, only longer numbers pay for the overflow checks
+    long long result = 0;
+    const char* digits = p;
+    while(p < end && (unsigned)(*p - '0') < 10 && p - digits < 18)
+    {
+        result = result * 10 + (*p - '0');
+        p++;
+    }
+    while(p < end && (unsigned)(*p - '0') < 10)
+    {
+        if(__builtin_mul_overflow(result, 10, &result) || __builtin_add_overflow(result, *p - '0', &result))
+        {
+            scanner->cursor = p;
+            return SCAN_OVERFLOW;
+        }
+        p++;
+    }
+    //a number has to end at whitespace or the end of the file
+    if(p < end && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r')
+    {
+        scanner->cursor = p;
+        return SCAN_BAD;
+    }
+
+    scanner->cursor = p;
+    *value = negative ? -result : result;
+    return SCAN_OK;
+}
+
+static bool has_binary_magic(const void* data, size_t length)
+{
+    return length >= sizeof(TasksetHeader) && memcmp(data, TASKSET_MAGIC, sizeof(TASKSET_MAGIC)) == 0;
+}
+
+//map a whole file read only, length 0 leaves mapping NULL
+static bool map_file(const char* path, int protection, int flags, void** mapping, size_t* length)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        fprintf(stderr,"[ERROR]: Error opening %s\n",path);
+        return false;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0)
+    {
+        fprintf(stderr,"[ERROR]: Error opening %s\n",path);
+        close(fd);
+        return false;
+    }
+
+    *length = (size_t) info.st_size;
+    *mapping = NULL;
+    if(*length > 0)
+    {
+        *mapping = mmap(NULL, *length, protection, flags, fd, 0);
+        if(*mapping == MAP_FAILED)
+        {
+            fprintf(stderr,"[ERROR]: Error mapping %s\n",path);
+            close(fd);
+            return false;
+        }
+    }
+    close(fd);
+    return true;
+}
+
+//check a binary header against this build, the record layout has to match Task exactly
+static bool valid_header(const char* path, const TasksetHeader* header, size_t length)
+{
+    if(header->version != TASKSET_VERSION)
+    {
+        fprintf(stderr,"[ERROR]: %s is binary taskset version %u, only version %d is supported\n",path,header->version,TASKSET_VERSION);
+        return false;
+    }
+    if(header->byte_order != TASKSET_BYTE_ORDER || header->record_size != sizeof(Task) || header->header_size != sizeof(TasksetHeader))
+    {
+        fprintf(stderr,"[ERROR]: %s was written on a machine with a different task layout\n",path);
+        return false;
+    }
+    if(header->num_tasks > INT_MAX || (length - sizeof(TasksetHeader)) / sizeof(Task) < header->num_tasks)
+    {
+        fprintf(stderr,"[ERROR]: %s is truncated\n",path);
+        return false;
+    }
+    return true;
+}
+
+//the same rules for both formats, a task the schedulers can not run is rejected up front
+static bool valid_task(const char* path, int index, sched_time_t arrival_time, sched_time_t period, sched_time_t execution_time, sched_time_t deadline)
+{
+    if(arrival_time < 0 || period <= 0 || execution_time < 0 || deadline <= 0)
+    {
+        fprintf(stderr,"[ERROR]: %s task %d (%lld %lld %lld %lld) needs A >= 0, P > 0, C >= 0 and D > 0\n",
+            path,index,arrival_time,period,execution_time,deadline);
+        return false;
+    }
+    return true;
+}
+
+//read a text taskset: task count, then one "arrival period execution deadline" line per task
+//the file is mapped and scanned in place, returns a heap array the caller frees
+//NULL (with the reason printed to stderr) if the file can not be read or holds an invalid task
+//a file with fewer tasks than it declares keeps the tasks that were read
+Task* load_taskset_text(const char* path, int* num_tasks)
+{
+    void* mapping;
+    size_t length;
+    if(!map_file(path, PROT_READ, MAP_PRIVATE, &mapping, &length))
+    {
+        return NULL;
+    }
+    if(mapping != NULL)
+    {
+        madvise(mapping, length, MADV_SEQUENTIAL);
+    }
+
+    Scanner scanner = { (const char*) mapping, (const char*) mapping + length, 1 };
+    long long declared = 0;
+    if(scan_integer(&scanner, &declared) != SCAN_OK || declared < 0 || declared > INT_MAX)
+    {
+        fprintf(stderr,"[ERROR]: %s does not start with a task count\n",path);
+        if(mapping != NULL) munmap(mapping, length);
+        return NULL;
+    }
+
+    Task* tasks = (Task*) malloc((declared > 0 ? declared : 1) * sizeof(Task));
+    int count = 0;
+    while(count < declared)
+    {
+        long long fields[4];
+        ScanResult result = SCAN_OK;
+        for(int f = 0; f < 4 && result == SCAN_OK; f++)
+        {
+            result = scan_integer(&scanner, &fields[f]);
+        }
+
+        if(result == SCAN_END)
+        {
+            fprintf(stderr,"[WARNING]: %s declares %lld tasks but only %d could be read\n",path,declared,count);
+            break;
+        }
+        if(result != SCAN_OK)
+        {
+            fprintf(stderr,"[ERROR]: %s line %d: %s\n",path,scanner.line,result == SCAN_OVERFLOW ? "number does not fit in 64 bits" : "expected a number");
+            free(tasks);
+            munmap(mapping, length);
+            return NULL;
+        }
+        if(!valid_task(path, count, fields[0], fields[1], fields[2], fields[3]))
+        {
+            free(tasks);
+            munmap(mapping, length);
+            return NULL;
+        }
+
+        tasks[count].arrival_time = fields[0];
+        tasks[count].period = fields[1];
+        tasks[count].execution_time = fields[2];
+        tasks[count].relative_deadline = fields[3];
+        tasks[count].task_id = count;
+        count++;
+    }
+    munmap(mapping, length);
+
+    *num_tasks = count;
+    return tasks;
+}
+
+//map a binary taskset copy on write and validate it, the tasks are used straight from the page cache
+//release with unmap_taskset, false (with the reason printed to stderr) if the file is not a usable binary taskset
+//only the benchmark loads this way, load_taskset's callers own and free their array so they get a copy
+bool map_taskset_binary(const char* path, TasksetMap* map)
+{
+    void* mapping;
+    size_t length;
+    if(!map_file(path, PROT_READ | PROT_WRITE, MAP_PRIVATE, &mapping, &length))
+    {
+        return false;
+    }
+    if(!has_binary_magic(mapping, length))
+    {
+        fprintf(stderr,"[ERROR]: %s is not a binary taskset\n",path);
+        if(mapping != NULL) munmap(mapping, length);
+        return false;
+    }
+
+    const TasksetHeader* header = (const TasksetHeader*) mapping;
+    if(!valid_header(path, header, length))
+    {
+        munmap(mapping, length);
+        return false;
+    }
+
+    Task* tasks = (Task*)((char*) mapping + sizeof(TasksetHeader));
+    for(uint64_t i = 0; i < header->num_tasks; i++)
+    {
+        if(!valid_task(path, (int) i, tasks[i].arrival_time, tasks[i].period, tasks[i].execution_time, tasks[i].relative_deadline))
+        {
+            munmap(mapping, length);
+            return false;
+        }
+    }
+
+    map->tasks = tasks;
+    map->num_tasks = (int) header->num_tasks;
+    map->mapping = mapping;
+    map->length = length;
+    return true;
+}
+
+void unmap_taskset(TasksetMap* map)
+{
+    if(map->mapping != NULL)
+    {
+        munmap(map->mapping, map->length);
+    }
+    map->mapping = NULL;
+    map->tasks = NULL;
+    map->num_tasks = 0;
+}
+
+//binary taskset into a heap array the caller frees, the records are read straight into it
+Task* load_taskset_binary(const char* path, int* num_tasks)
+{
+    FILE* file = fopen(path, "rb");
+    if(file == NULL)
+    {
+        fprintf(stderr,"[ERROR]: Error opening %s\n",path);
+        return NULL;
+    }
+
+    TasksetHeader header;
+    struct stat info;
+    if(fread(&header, sizeof(header), 1, file) != 1 || fstat(fileno(file), &info) != 0
+       || !has_binary_magic(&header, sizeof(header)))
+    {
+        fprintf(stderr,"[ERROR]: %s is not a binary taskset\n",path);
+        fclose(file);
+        return NULL;
+    }
+    if(!valid_header(path, &header, (size_t) info.st_size))
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    int count = (int) header.num_tasks;
+    Task* tasks = (Task*) malloc((count > 0 ? count : 1) * sizeof(Task));
+    if(fread(tasks, sizeof(Task), count, file) != (size_t) count)
+    {
+        fprintf(stderr,"[ERROR]: %s is truncated\n",path);
+        free(tasks);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+
+    for(int i = 0; i < count; i++)
+    {
+        if(!valid_task(path, i, tasks[i].arrival_time, tasks[i].period, tasks[i].execution_time, tasks[i].relative_deadline))
+        {
+            free(tasks);
+            return NULL;
+        }
+    }
+    *num_tasks = count;
+    return tasks;
+}
+
+//load either format, binary files are told apart by their magic
+//both come back as a heap array the caller frees, binary ones through load_taskset_binary, not the mapping
+Task* load_taskset(const char* path, int* num_tasks)
+{
+    FILE* file = fopen(path, "rb");
+    if(file == NULL)
+    {
+        fprintf(stderr,"[ERROR]: Error opening %s\n",path);
+        return NULL;
+    }
+    char magic[sizeof(TASKSET_MAGIC)];
+    bool binary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, TASKSET_MAGIC, sizeof(magic)) == 0;
+    fclose(file);
+
+    return binary ? load_taskset_binary(path, num_tasks) : load_taskset_text(path, num_tasks);
+}
+
+//write a taskset in the text format load_taskset reads
+bool write_taskset(FILE* file, Task tasks[], int num_tasks)
+{
+    fprintf(file, "%d\n", num_tasks);
+    for(int i = 0; i < num_tasks; i++)
+    {
+        fprintf(file, "%lld\t%lld\t%lld\t%lld\n", tasks[i].arrival_time, tasks[i].period, tasks[i].execution_time, tasks[i].relative_deadline);
+    }
+    return !ferror(file);
+}
+
+//write a binary taskset, the records go out with ids and run state reset so they can be mapped and run as is
+bool write_taskset_binary(FILE* file, Task tasks[], int num_tasks)
+{
+    TasksetHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TASKSET_MAGIC, sizeof(TASKSET_MAGIC));
+    header.version = TASKSET_VERSION;
+    header.byte_order = TASKSET_BYTE_ORDER;
+    header.record_size = sizeof(Task);
+    header.header_size = sizeof(TasksetHeader);
+    header.num_tasks = num_tasks;
+    fwrite(&header, sizeof(header), 1, file);
+
+    for(int i = 0; i < num_tasks; i++)
+    {
+        Task record;
+        memset(&record, 0, sizeof(record));
+        record.task_id = i;
+        record.arrival_time = tasks[i].arrival_time;
+        record.period = tasks[i].period;
+        record.execution_time = tasks[i].execution_time;
+        record.relative_deadline = tasks[i].relative_deadline;
+        fwrite(&record, sizeof(record), 1, file);
+    }
+    return !ferror(file);
+}
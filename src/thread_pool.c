@@ -0,0 +1,218 @@
+#include "../include/thread_pool.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+#define INITIAL_DEQUE_CAPACITY 64
+
+typedef struct worker_start
+{
+    ThreadPool* pool;
+    int index;
+} WorkerStart;
+
+int default_thread_count(void)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int) cores : 1;
+}
+
+static void deque_push_back(WorkDeque* deque, WorkItem item)
+{
+    pthread_mutex_lock(&deque->lock);
+    if(deque->count == deque->capacity)
+    {
+        //unroll the ring into a bigger buffer
+        WorkItem* items = (WorkItem*) malloc(2 * deque->capacity * sizeof(WorkItem));
+        for(int i = 0; i < deque->count; i++)
+        {
+            items[i] = deque->items[(deque->head + i) % deque->capacity];
+        }
+        free(deque->items);
+        deque->items = items;
+        deque->head = 0;
+        deque->capacity *= 2;
+    }
+    deque->items[(deque->head + deque->count) % deque->capacity] = item;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+static bool deque_pop_front(WorkDeque* deque, WorkItem* item)
+{
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if(deque->count > 0)
+    {
+        *item = deque->items[deque->head];
+        deque->head = (deque->head + 1) % deque->capacity;
+        deque->count--;
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool deque_steal_back(WorkDeque* deque, WorkItem* item)
+{
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if(deque->count > 0)
+    {
+        deque->count--;
+        *item = deque->items[(deque->head + deque->count) % deque->capacity];
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+//own deque first, then walk the other workers and steal
+static bool take_work(ThreadPool* pool, int self, WorkItem* item)
+{
+    if(deque_pop_front(&pool->deques[self], item))
+    {
+        return true;
+    }
+    for(int i = 1; i < pool->num_threads; i++)
+    {
+        if(deque_steal_back(&pool->deques[(self + i) % pool->num_threads], item))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void* worker_main(void* arg)
+{
+    WorkerStart* start = (WorkerStart*) arg;
+    ThreadPool* pool = start->pool;
+    int self = start->index;
+    free(start);
+
+    while(true)
+    {
+        WorkItem item;
+        if(take_work(pool, self, &item))
+        {
+            __atomic_sub_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+            item.fn(item.arg);
+
+            if(__atomic_sub_fetch(&pool->pending, 1, __ATOMIC_SEQ_CST) == 0)
+            {
+                pthread_mutex_lock(&pool->lock);
+                pthread_cond_broadcast(&pool->all_done);
+                pthread_mutex_unlock(&pool->lock);
+            }
+            continue;
+        }
+
+        //nothing to run or steal, sleep till more work is submitted
+        pthread_mutex_lock(&pool->lock);
+        while(__atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) <= 0 && !pool->shutting_down)
+        {
+            pthread_cond_wait(&pool->work_available, &pool->lock);
+        }
+        bool done = pool->shutting_down && __atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) <= 0;
+        pthread_mutex_unlock(&pool->lock);
+        if(done)
+        {
+            break;
+        }
+    }
+    return NULL;
+}
+
+ThreadPool* new_ThreadPool(int num_threads)
+{
+    if(num_threads < 1)
+    {
+        num_threads = 1;
+    }
+
+    ThreadPool* pool = (ThreadPool*) malloc(sizeof(ThreadPool));
+    pool->num_threads = num_threads;
+    pool->next_deque = 0;
+    pool->queued = 0;
+    pool->pending = 0;
+    pool->shutting_down = false;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_available, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+
+    pool->deques = (WorkDeque*) malloc(num_threads * sizeof(WorkDeque));
+    for(int i = 0; i < num_threads; i++)
+    {
+        pool->deques[i].items = (WorkItem*) malloc(INITIAL_DEQUE_CAPACITY * sizeof(WorkItem));
+        pool->deques[i].head = 0;
+        pool->deques[i].count = 0;
+        pool->deques[i].capacity = INITIAL_DEQUE_CAPACITY;
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+    }
+
+    pool->threads = (pthread_t*) malloc(num_threads * sizeof(pthread_t));
+    for(int i = 0; i < num_threads; i++)
+    {
+        WorkerStart* start = (WorkerStart*) malloc(sizeof(WorkerStart));
+        start->pool = pool;
+        start->index = i;
+        pthread_create(&pool->threads[i], NULL, worker_main, start);
+    }
+    return pool;
+}
+
+//queue fn(arg) on the next worker in round robin order, meant to be called from one submitting thread
+void thread_pool_submit(ThreadPool* pool, work_fn fn, void* arg)
+{
+    WorkItem item = { fn, arg };
+    int target = pool->next_deque;
+    pool->next_deque = (pool->next_deque + 1) % pool->num_threads;
+
+    //queued only counts an item once it is on a deque, so a woken worker always finds what it was promised,
+    //a worker already awake can take the item first and leave queued at -1 till the add below
+    __atomic_add_fetch(&pool->pending, 1, __ATOMIC_SEQ_CST);
+    deque_push_back(&pool->deques[target], item);
+    __atomic_add_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+//block till every submitted item has finished running
+void thread_pool_wait(ThreadPool* pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    while(__atomic_load_n(&pool->pending, __ATOMIC_SEQ_CST) > 0)
+    {
+        pthread_cond_wait(&pool->all_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+//finish the queued work, join the workers and release everything
+void free_ThreadPool(ThreadPool* pool)
+{
+    if(pool == NULL) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutting_down = true;
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(int i = 0; i < pool->num_threads; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for(int i = 0; i < pool->num_threads; i++)
+    {
+        free(pool->deques[i].items);
+        pthread_mutex_destroy(&pool->deques[i].lock);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_available);
+    pthread_cond_destroy(&pool->all_done);
+    free(pool->deques);
+    free(pool->threads);
+    free(pool);
+}
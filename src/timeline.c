@@ -0,0 +1,97 @@
+#include "../include/timeline.h"
+#include <stdlib.h>
+
+#define INITIAL_SEGMENTS 64
+
+void timeline_init(Timeline* timeline)
+{
+    timeline->segments = (Segment*) malloc(INITIAL_SEGMENTS * sizeof(Segment));
+    timeline->count = 0;
+    timeline->capacity = INITIAL_SEGMENTS;
+    timeline->consumer = NULL;
+    timeline->context = NULL;
+    timeline->decisions = 0;
+}
+
+void timeline_init_stream(Timeline* timeline, int buffer_segments, segment_consumer consumer, void* context)
+{
+    //the last segment stays behind for merging, so at least two slots are needed
+    if(buffer_segments < 2)
+    {
+        buffer_segments = 2;
+    }
+    timeline->segments = (Segment*) malloc(buffer_segments * sizeof(Segment));
+    timeline->count = 0;
+    timeline->capacity = buffer_segments;
+    timeline->consumer = consumer;
+    timeline->context = context;
+    timeline->decisions = 0;
+}
+
+//hand all but the last segment to the consumer, the last one may still grow
+static void drain(Timeline* timeline)
+{
+    for(int i = 0; i < timeline->count - 1; i++)
+    {
+        timeline->consumer(&timeline->segments[i], timeline->context);
+    }
+    timeline->segments[0] = timeline->segments[timeline->count - 1];
+    timeline->count = 1;
+}
+
+//record that the cpu ran the given job over [start, end), a NULL timeline discards it
+//consecutive runs of the same job are merged into one segment
+void timeline_append(Timeline* timeline, sched_time_t start, sched_time_t end, int task_id, long long job_instance)
+{
+    if(timeline == NULL) return;
+    timeline->decisions++;
+    if(end <= start) return;
+
+    if(timeline->count > 0)
+    {
+        Segment* last = &timeline->segments[timeline->count - 1];
+        if(last->end == start && last->task_id == task_id && last->job_instance == job_instance)
+        {
+            last->end = end;
+            return;
+        }
+    }
+
+    if(timeline->count == timeline->capacity)
+    {
+        if(timeline->consumer != NULL)
+        {
+            drain(timeline);
+        }
+        else
+        {
+            timeline->capacity *= 2;
+            timeline->segments = (Segment*) realloc(timeline->segments, timeline->capacity * sizeof(Segment));
+        }
+    }
+
+    Segment* segment = &timeline->segments[timeline->count++];
+    segment->start = start;
+    segment->end = end;
+    segment->task_id = task_id;
+    segment->job_instance = job_instance;
+}
+
+//push every buffered segment to the consumer, call once the run is over
+void timeline_flush(Timeline* timeline)
+{
+    if(timeline->consumer == NULL) return;
+    for(int i = 0; i < timeline->count; i++)
+    {
+        timeline->consumer(&timeline->segments[i], timeline->context);
+    }
+    timeline->count = 0;
+}
+
+void timeline_free(Timeline* timeline)
+{
+    free(timeline->segments);
+    timeline->segments = NULL;
+    timeline->count = 0;
+    timeline->capacity = 0;
+}
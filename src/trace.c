@@ -0,0 +1,184 @@
+#include "../include/trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//records the exporter copies out of the ring per pass
+#define TRACE_DRAIN_BATCH 4096
+
+__thread TraceBuffer* trace_current = NULL;
+
+//a job running on a core whose end has not been seen yet
+typedef struct open_slice
+{
+    bool open;
+    sched_time_t start;
+    int task_id;
+    long long instance;
+} OpenSlice;
+
+static const char* type_names[] = { "release", "dispatch", "preempt", "complete", "deadline miss", "rekey", "migrate" };
+
+//capacity is rounded up to a power of two
+TraceBuffer* new_TraceBuffer(size_t capacity)
+{
+    size_t size = 1;
+    while(size < capacity) size <<= 1;
+    TraceBuffer* buffer = (TraceBuffer*) calloc(1, sizeof(TraceBuffer));
+    buffer->records = (TraceRecord*) malloc(size * sizeof(TraceRecord));
+    buffer->mask = size - 1;
+    return buffer;
+}
+
+void free_TraceBuffer(TraceBuffer* buffer)
+{
+    if(buffer == NULL) return;
+    free(buffer->records);
+    free(buffer);
+}
+
+//consumer side, copies out up to max_records of the oldest records and frees their slots
+size_t trace_drain(TraceBuffer* buffer, TraceRecord out[], size_t max_records)
+{
+    size_t tail = __atomic_load_n(&buffer->tail, __ATOMIC_RELAXED);
+    size_t head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+    size_t count = head - tail;
+    if(count > max_records) count = max_records;
+    for(size_t i = 0; i < count; i++)
+    {
+        out[i] = buffer->records[(tail + i) & buffer->mask];
+    }
+    __atomic_store_n(&buffer->tail, tail + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+static void begin_event(TraceExporter* exporter)
+{
+    fputs(exporter->first_event ? "\n" : ",\n", exporter->out);
+    exporter->first_event = false;
+    exporter->exported++;
+}
+
+//chrome trace timestamps are in microseconds, one time unit is shown as one microsecond
+static OpenSlice* slice_of(TraceExporter* exporter, int core)
+{
+    if(core >= exporter->num_cores)
+    {
+        int num_cores = exporter->num_cores;
+        exporter->num_cores = core + 1;
+        exporter->slices = (OpenSlice*) realloc(exporter->slices, exporter->num_cores * sizeof(OpenSlice));
+        for(int c = num_cores; c < exporter->num_cores; c++)
+        {
+            exporter->slices[c].open = false;
+            begin_event(exporter);
+            fprintf(exporter->out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"core %d\"}}", c, c);
+        }
+    }
+    return &exporter->slices[core];
+}
+
+static void close_slice(TraceExporter* exporter, int core, sched_time_t end)
+{
+    OpenSlice* slice = slice_of(exporter, core);
+    if(!slice->open) return;
+    slice->open = false;
+    begin_event(exporter);
+    fprintf(exporter->out, "{\"name\":\"J%d,%lld\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%lld,\"dur\":%lld,\"args\":{\"task\":%d,\"job\":%lld}}",
+        slice->task_id, slice->instance, core, slice->start, end - slice->start, slice->task_id, slice->instance);
+}
+
+//running jobs become slices on their core's track, everything else an instant on the task's track
+static void export_record(TraceExporter* exporter, const TraceRecord* record)
+{
+    exporter->last_time = record->time;
+    switch(record->type)
+    {
+        case TRACE_DISPATCH:
+        {
+            close_slice(exporter, record->core, record->time);
+            OpenSlice* slice = slice_of(exporter, record->core);
+            slice->open = true;
+            slice->start = record->time;
+            slice->task_id = record->task_id;
+            slice->instance = record->instance;
+            return;
+        }
+        case TRACE_PREEMPT:
+        case TRACE_COMPLETE:
+            close_slice(exporter, record->core, record->time);
+            if(record->type == TRACE_COMPLETE) return;
+            break;
+        case TRACE_REKEY:
+            begin_event(exporter);
+            fprintf(exporter->out, "{\"name\":\"key T%d\",\"ph\":\"C\",\"pid\":1,\"ts\":%lld,\"args\":{\"key\":%lld}}",
+                record->task_id, record->time, record->value);
+            return;
+        default:
+            break;
+    }
+    begin_event(exporter);
+    fprintf(exporter->out, "{\"name\":\"%s J%d,%lld\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"args\":{\"core\":%d,\"value\":%lld}}",
+        type_names[record->type], record->task_id, record->instance, record->task_id, record->time, record->core, record->value);
+}
+
+static size_t export_pass(TraceExporter* exporter, TraceRecord batch[])
+{
+    size_t count = trace_drain(exporter->buffer, batch, TRACE_DRAIN_BATCH);
+    for(size_t i = 0; i < count; i++)
+    {
+        export_record(exporter, &batch[i]);
+    }
+    return count;
+}
+
+static void* export_thread(void* arg)
+{
+    TraceExporter* exporter = (TraceExporter*) arg;
+    TraceRecord* batch = (TraceRecord*) malloc(TRACE_DRAIN_BATCH * sizeof(TraceRecord));
+    struct timespec pause = { 0, 1000000 };
+    while(!__atomic_load_n(&exporter->stopping, __ATOMIC_ACQUIRE))
+    {
+        if(export_pass(exporter, batch) == 0)
+        {
+            nanosleep(&pause, NULL);
+        }
+    }
+    while(export_pass(exporter, batch) > 0);
+    free(batch);
+    return NULL;
+}
+
+//start writing the json header and draining buffer on a background thread
+bool trace_export_start(TraceExporter* exporter, TraceBuffer* buffer, FILE* out)
+{
+    memset(exporter, 0, sizeof(TraceExporter));
+    exporter->buffer = buffer;
+    exporter->out = out;
+    exporter->first_event = true;
+    buffer->dropped = 0;
+
+    fputs("{\"traceEvents\":[", out);
+    begin_event(exporter);
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"cores\"}}", out);
+    begin_event(exporter);
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"tasks\"}}", out);
+    exporter->exported = 0;
+
+    return pthread_create(&exporter->thread, NULL, export_thread, exporter) == 0;
+}
+
+//drain what is left, close the slices still running at end and the json, returns the number of events written
+long long trace_export_stop(TraceExporter* exporter, sched_time_t end)
+{
+    __atomic_store_n(&exporter->stopping, true, __ATOMIC_RELEASE);
+    pthread_join(exporter->thread, NULL);
+
+    for(int c = 0; c < exporter->num_cores; c++)
+    {
+        close_slice(exporter, c, end > exporter->last_time ? end : exporter->last_time);
+    }
+    fputs("\n]}\n", exporter->out);
+    free(exporter->slices);
+    exporter->slices = NULL;
+    return exporter->exported;
+}
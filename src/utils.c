@@ -1,18 +1,20 @@
 #include "../include/task.h"
 #include "../include/utils.h"
 #include "../include/sched_new.h"
+#include "../include/job_pool.h"
+#include "../include/analysis.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 
 //calculate gcd of num1 and num2
-int gcd(int num1, int num2)
+sched_time_t gcd(sched_time_t num1, sched_time_t num2)
 {
     while(num2 != 0)
     {
-        int temp = num2;
+        sched_time_t temp = num2;
         num2 = num1%num2;
         num1 = temp;
     }
@@ -20,26 +22,51 @@ int gcd(int num1, int num2)
     return num1;
 }
 
-//calculate lcm of num1 and num2
-int lcm(int num1, int num2)
-{ 
-    return (num1 * num2)/(gcd(num1,num2));
+//calculate lcm of num1 and num2, false if it does not fit in 64 bits
+//dividing before multiplying keeps the intermediate no larger than the result
+bool lcm(sched_time_t num1, sched_time_t num2, sched_time_t* result)
+{
+    return !__builtin_mul_overflow(num1 / gcd(num1,num2), num2, result);
 }
 
-//calculate lcm of all periods to get the hyperperiod
-int calculate_hyperperiod(Task tasks[], int num_tasks)
+//calculate lcm of all periods to get the hyperperiod, -1 if it overflows 64 bits
+sched_time_t calculate_hyperperiod(Task tasks[], int num_tasks)
 {
-    int _lcm = tasks[0].period;
+    if(num_tasks == 0) return 0;
+    sched_time_t _lcm = tasks[0].period;
     for(int i = 1; i < num_tasks; i++)
     {
-        _lcm = lcm(_lcm, tasks[i].period);
+        if(!lcm(_lcm, tasks[i].period, &_lcm))
+        {
+            return -1;
+        }
     }
 
     return _lcm;
 }
 
+//how long to simulate: an explicit horizon wins, otherwise the hyperperiod clipped to cap
+//a hyperperiod that overflows always falls back to the cap
+sched_time_t simulation_horizon(Task tasks[], int num_tasks, sched_time_t horizon, sched_time_t cap)
+{
+    if(horizon > 0)
+    {
+        return horizon;
+    }
+
+    sched_time_t hyperperiod = calculate_hyperperiod(tasks, num_tasks);
+    if(hyperperiod < 0 || hyperperiod > cap)
+    {
+        return cap;
+    }
+    return hyperperiod;
+}
+
 //check for schedulability for EDF and RM
-bool schedulability(Task tasks[], int num_tasks, char _type)
+//'F' liu-layland bound, 'R' / 'M' exact RTA under RM / DM, 'A' Audsley's optimal priority assignment over the same RTA,
+//'D' EDF utilization bound or exact demand analysis
+//opa_order is an order optimal_priority_order already found for 'A', NULL to search it here
+bool schedulability(Task tasks[], int num_tasks, char _type, const int opa_order[])
 {
 
     //calculate CPU utilization for the given taskset
@@ -66,9 +93,88 @@ bool schedulability(Task tasks[], int num_tasks, char _type)
             return false;
         }
     }
+    //exact response time analysis, rate monotonic ('R'), deadline monotonic ('M') or optimal ('A') priorities
+    else if(_type == 'R' || _type == 'M' || _type == 'A')
+    {
+        const char* name = _type == 'R' ? "RM" : _type == 'M' ? "DM" : "OPA";
+        int* order = (int*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(int));
+        sched_time_t* wcrt = (sched_time_t*) malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(sched_time_t));
+
+        bool schedulable;
+        if(_type == 'A' && opa_order != NULL)
+        {
+            memcpy(order, opa_order, num_tasks * sizeof(int));
+            schedulable = response_time_analysis(tasks, num_tasks, order, wcrt);
+        }
+        else if(_type == 'A')
+        {
+            schedulable = optimal_priority_order(tasks, num_tasks, order, wcrt);
+        }
+        else
+        {
+            priority_order(tasks, num_tasks, _type == 'R' ? PRIORITY_RATE_MONOTONIC : PRIORITY_DEADLINE_MONOTONIC, order);
+            schedulable = response_time_analysis(tasks, num_tasks, order, wcrt);
+        }
+
+        if(_type == 'A')
+        {
+            printf("%s priority order:",schedulable ? "optimal" : "no feasible");
+            for(int level = 0; level < num_tasks; level++)
+            {
+                printf(" T%d",order[level]);
+            }
+            printf("\n");
+        }
+
+        printf("T#\tR\tD\n");
+        for(int i = 0; i < num_tasks; i++)
+        {
+            if(wcrt[i] <= tasks[i].relative_deadline)
+            printf("T%d\t%lld\t%lld\n",i,wcrt[i],tasks[i].relative_deadline);
+            else
+            printf("T%d\t>%lld\t%lld\n",i,tasks[i].relative_deadline,tasks[i].relative_deadline);
+        }
+        if(schedulable)
+        {
+            printf("response time analysis: schedulable under %s\n",name);
+        }
+        else
+        {
+            printf("response time analysis: not schedulable under %s\n",_type == 'A' ? "any fixed priority order" : name);
+        }
+
+        free(order);
+        free(wcrt);
+        return schedulable;
+    }
     //upper bound for edf is 1 i.e 100% utilization
+    //the bound is only exact for implicit deadlines, anything else goes through processor demand analysis
     else if(_type == 'D')
     {
+        bool implicit_deadlines = true;
+        for(int i = 0; i < num_tasks; i++)
+        {
+            if(tasks[i].relative_deadline != tasks[i].period)
+            {
+                implicit_deadlines = false;
+            }
+        }
+
+        if(!implicit_deadlines)
+        {
+            sched_time_t failing_interval = 0;
+            if(edf_demand_analysis(tasks, num_tasks, &failing_interval))
+            {
+                printf("processor demand analysis (U=%f): schedulable under EDF and LLF\n",cpu_utilization);
+                return true;
+            }
+            else
+            {
+                printf("processor demand analysis (U=%f): demand exceeds [0,%lld], not schedulable under EDF\n",cpu_utilization,failing_interval);
+                return false;
+            }
+        }
+
         double upper_bound = 1;
         if(cpu_utilization <= upper_bound)
         {
@@ -89,39 +195,119 @@ bool schedulability(Task tasks[], int num_tasks, char _type)
 
 }
 
+//split a taskset into one array per parameter, all in a single block, so the engines can share it read only
+Taskset* new_Taskset(const Task tasks[], int num_tasks)
+{
+    int n = num_tasks > 0 ? num_tasks : 1;
+    Taskset* taskset = (Taskset*) malloc(sizeof(Taskset));
+    sched_time_t* block = (sched_time_t*) malloc(5 * n * sizeof(sched_time_t));
+    taskset->num_tasks = num_tasks;
+    taskset->arrival_time = block;
+    taskset->period = block + n;
+    taskset->execution_time = block + 2 * n;
+    taskset->relative_deadline = block + 3 * n;
+    taskset->priority = block + 4 * n;
+    taskset->preemption_cost = 0;
+    taskset->migration_cost = 0;
+    taskset->preemption_threshold = NULL;
+    taskset->non_preemptive_region = NULL;
+    taskset->task_id = (int*) malloc(n * sizeof(int));
+    for(int i = 0; i < num_tasks; i++)
+    {
+        taskset->task_id[i] = tasks[i].task_id;
+        taskset->arrival_time[i] = tasks[i].arrival_time;
+        taskset->period[i] = tasks[i].period;
+        taskset->execution_time[i] = tasks[i].execution_time;
+        taskset->relative_deadline[i] = tasks[i].relative_deadline;
+        taskset->priority[i] = tasks[i].period;
+    }
+    return taskset;
+}
+
+//explicit fixed priorities, order[] lists task indices from highest to lowest priority as the analysis fills it
+//only while no run uses the taskset, every task gets its level so no two tasks tie
+void assign_priorities(Taskset* taskset, const int order[])
+{
+    for(int level = 0; level < taskset->num_tasks; level++)
+    {
+        taskset->priority[order[level]] = level;
+    }
+}
+
+void free_Taskset(Taskset* taskset)
+{
+    if(taskset == NULL) return;
+    free(taskset->arrival_time);
+    free(taskset->task_id);
+    free(taskset);
+}
+
+//fresh run state: every task's first release is its arrival time and nothing is released yet
+void init_run_context(RunContext* context, const Taskset* taskset)
+{
+    int n = taskset->num_tasks > 0 ? taskset->num_tasks : 1;
+    context->taskset = taskset;
+    context->next_release = (sched_time_t*) malloc(n * sizeof(sched_time_t));
+    context->instances = (long long*) calloc(n, sizeof(long long));
+    context->sampler = NULL;
+    memcpy(context->next_release, taskset->arrival_time, taskset->num_tasks * sizeof(sched_time_t));
+}
+
+void free_run_context(RunContext* context)
+{
+    free(context->next_release);
+    free(context->instances);
+}
+
 void print_taskset(Task tasks[], int num_tasks)
 {
     printf("T#\tA\tP\tC\tD\n");
     for(int i = 0; i < num_tasks; i++)
     {
-        printf("T%d\t%d\t%d\t%d\t%d\n",i,tasks[i].arrival_time,tasks[i].period,tasks[i].execution_time,tasks[i].relative_deadline);
+        printf("T%d\t%lld\t%lld\t%lld\t%lld\n",i,tasks[i].arrival_time,tasks[i].period,tasks[i].execution_time,tasks[i].relative_deadline);
     }
 }
 
 
-void plot_timeline(int schedule_log[][2], int total_time)
+//print one segment tick by tick, usable as the consumer of a streaming timeline
+void plot_segment(const Segment* segment, void* context)
 {
-    for(int i = 0; i < total_time; i++)
+    (void) context;
+    for(sched_time_t i = segment->start; i < segment->end; i++)
     {
-        if(schedule_log[i][0] != -1)
-        printf("J%d,%d\t",schedule_log[i][0],schedule_log[i][1]);
+        if(segment->task_id != -1)
+        printf("J%d,%lld\t",segment->task_id,segment->job_instance);
         else
         printf("IDLE\t");
     }
+}
+
+void plot_timeline(Timeline* timeline)
+{
+    for(int i = 0; i < timeline->count; i++)
+    {
+        plot_segment(&timeline->segments[i], NULL);
+    }
     printf("\n");
 }
 
 
-Job* allocate_job(Task* task, int cur_time)
+//take a job from the scheduler's pool, falls back to malloc when no pool is given
+Job* allocate_job(JobPool* pool, const Taskset* taskset, int task, long long instance, sched_time_t cur_time)
 {
-    //srand(time(NULL));
-
-    Job* job = (Job*) malloc(sizeof(Job));
+    Job* job = pool != NULL ? job_pool_alloc_job(pool) : (Job*) malloc(sizeof(Job));
     
-    job->absolute_deadline = cur_time + task->relative_deadline;
-    job->actual_execution_time = task->execution_time; //(rand() % (task.execution_time  + 1));
-    job->job_task = task;
+    job->release_time = cur_time;
+    job->absolute_deadline = cur_time + taskset->relative_deadline[task];
+    job->actual_execution_time = taskset->execution_time[task];
+    job->task = task;
+    job->instance = instance;
     job->remaining_execution_time = job->actual_execution_time;
+    job->start_time = -1;
+    job->preemptable_at = -1;
+    job->preemptions = 0;
+    job->migrations = 0;
+    job->last_core = -1;
 
     return job;
 }
\ No newline at end of file